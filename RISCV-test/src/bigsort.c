@@ -0,0 +1,42 @@
+#include "io.inc"
+int a[16384];
+unsigned seed = 2463534242;
+
+unsigned rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+void sort(int l, int r) {
+  int i = l, j = r, p = a[(l + r) >> 1];
+  while (i <= j) {
+    while (a[i] < p) ++i;
+    while (a[j] > p) --j;
+    if (i <= j) {
+      int t = a[i];
+      a[i] = a[j];
+      a[j] = t;
+      ++i;
+      --j;
+    }
+  }
+  if (l < j) sort(l, j);
+  if (i < r) sort(i, r);
+}
+
+int main() {
+  for (int round = 0; round < 8; ++round) {
+    for (int i = 0; i < 16384; ++i)
+      a[i] = rnd() >> 1;
+    sort(0, 16383);
+    int bad = 0;
+    for (int i = 1; i < 16384; ++i)
+      if (a[i - 1] > a[i]) ++bad;
+    printInt(bad);
+    printInt(a[8192] & 65535);
+    printInt(a[round * 1000] & 65535);
+  }
+  return judgeResult % Mod;  // 14
+}
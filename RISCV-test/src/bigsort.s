@@ -0,0 +1,170 @@
+# Hand-written RV32I translation of bigsort.c.
+    .option norelax
+    .equ A, 0x20000
+    .text
+    lui sp, 0x20
+    jal ra, main
+    li a2, 255
+    lui a3, 0x30
+    sb a2, 4(a3)
+1:  j 1b
+
+    .org 0x1000
+printInt:
+    la t0, judgeResult
+    lw t1, 0(t0)
+    xor t1, t1, a0
+    addi t1, t1, 173
+    sw t1, 0(t0)
+    ret
+
+__umodsi3:
+    mv a2, a1
+    li a3, 1
+1:  bgeu a2, a0, 2f
+    bltz a2, 2f
+    slli a2, a2, 1
+    slli a3, a3, 1
+    j 1b
+2:  bltu a0, a2, 3f
+    sub a0, a0, a2
+3:  srli a2, a2, 1
+    srli a3, a3, 1
+    bnez a3, 2b
+    ret
+
+rnd:
+    la t0, seed
+    lw a0, 0(t0)
+    slli t1, a0, 13
+    xor a0, a0, t1
+    srli t1, a0, 17
+    xor a0, a0, t1
+    slli t1, a0, 5
+    xor a0, a0, t1
+    sw a0, 0(t0)
+    ret
+
+sort:
+    addi sp, sp, -16
+    sw ra, 12(sp)
+    sw s0, 8(sp)
+    sw s1, 4(sp)
+    sw s2, 0(sp)
+    mv s0, a0
+    mv s1, a1
+    li t6, A
+    add t0, a0, a1
+    srai t0, t0, 1
+    slli t0, t0, 2
+    add t0, t0, t6
+    lw t5, 0(t0)
+    mv t1, a0
+    mv t2, a1
+.Louter:
+    blt t2, t1, .Ldone
+.Li:
+    slli a2, t1, 2
+    add a2, a2, t6
+    lw a4, 0(a2)
+    bge a4, t5, .Lj
+    addi t1, t1, 1
+    j .Li
+.Lj:
+    slli a3, t2, 2
+    add a3, a3, t6
+    lw a5, 0(a3)
+    bge t5, a5, .Lswap
+    addi t2, t2, -1
+    j .Lj
+.Lswap:
+    blt t2, t1, .Louter
+    sw a5, 0(a2)
+    sw a4, 0(a3)
+    addi t1, t1, 1
+    addi t2, t2, -1
+    j .Louter
+.Ldone:
+    mv s2, t1
+    bge s0, t2, 1f
+    mv a0, s0
+    mv a1, t2
+    call sort
+1:  bge s2, s1, 2f
+    mv a0, s2
+    mv a1, s1
+    call sort
+2:  lw ra, 12(sp)
+    lw s0, 8(sp)
+    lw s1, 4(sp)
+    lw s2, 0(sp)
+    addi sp, sp, 16
+    ret
+
+main:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    sw s1, 20(sp)
+    sw s2, 16(sp)
+    sw s3, 12(sp)
+    sw s4, 8(sp)
+    li s3, 0
+    li s4, 0
+.Lround:
+    li s0, A
+    li s1, A + 65536
+.Lfill:
+    call rnd
+    srli a0, a0, 1
+    sw a0, 0(s0)
+    addi s0, s0, 4
+    bne s0, s1, .Lfill
+    li a0, 0
+    li a1, 16383
+    call sort
+    li s0, A + 4
+    li s2, 0
+.Lcheck:
+    lw t0, -4(s0)
+    lw t1, 0(s0)
+    bge t1, t0, 1f
+    addi s2, s2, 1
+1:  addi s0, s0, 4
+    bne s0, s1, .Lcheck
+    mv a0, s2
+    call printInt
+    li t0, A + 32768
+    lw a0, 0(t0)
+    slli a0, a0, 16
+    srli a0, a0, 16
+    call printInt
+    li t0, A
+    add t0, t0, s4
+    lw a0, 0(t0)
+    slli a0, a0, 16
+    srli a0, a0, 16
+    call printInt
+    li t0, 1000 * 4
+    add s4, s4, t0
+    addi s3, s3, 1
+    li t0, 8
+    bne s3, t0, .Lround
+    la t0, judgeResult
+    lw a0, 0(t0)
+    li a1, 253
+    call __umodsi3
+    lw ra, 28(sp)
+    lw s0, 24(sp)
+    lw s1, 20(sp)
+    lw s2, 16(sp)
+    lw s3, 12(sp)
+    lw s4, 8(sp)
+    addi sp, sp, 32
+    ret
+
+    .org 0x8000
+judgeResult:
+    .word 0
+seed:
+    .word 2463534242
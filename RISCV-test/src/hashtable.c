@@ -0,0 +1,50 @@
+#include "io.inc"
+unsigned keys[8192];
+int vals[8192];
+unsigned seed = 88172645;
+
+unsigned rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+unsigned hash(unsigned k) {
+  k ^= k >> 7;
+  k ^= k << 9;
+  k ^= k >> 13;
+  return k & 8191;
+}
+
+void insert(unsigned k, int v) {
+  unsigned h = hash(k);
+  while (keys[h] != 0 && keys[h] != k) h = (h + 1) & 8191;
+  keys[h] = k;
+  vals[h] += v;
+}
+
+int lookup(unsigned k) {
+  unsigned h = hash(k);
+  while (keys[h] != 0) {
+    if (keys[h] == k) return vals[h];
+    h = (h + 1) & 8191;
+  }
+  return -1;
+}
+
+int main() {
+  for (int i = 0; i < 6000; ++i)
+    insert((rnd() & 16383) | 1, i & 255);
+  int found = 0, sum = 0;
+  for (int i = 0; i < 400000; ++i) {
+    int v = lookup((rnd() & 16383) | 1);
+    if (v >= 0) {
+      ++found;
+      sum += v;
+    }
+  }
+  printInt(found & 65535);
+  printInt(sum & 65535);
+  return judgeResult % Mod;  // 227
+}
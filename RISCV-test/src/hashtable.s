@@ -0,0 +1,171 @@
+# Hand-written RV32I translation of hashtable.c.
+    .option norelax
+    .equ KEYS, 0x20000
+    .equ VALS, 0x28000
+    .text
+    lui sp, 0x20
+    jal ra, main
+    li a2, 255
+    lui a3, 0x30
+    sb a2, 4(a3)
+1:  j 1b
+
+    .org 0x1000
+printInt:
+    la t0, judgeResult
+    lw t1, 0(t0)
+    xor t1, t1, a0
+    addi t1, t1, 173
+    sw t1, 0(t0)
+    ret
+
+__umodsi3:
+    mv a2, a1
+    li a3, 1
+1:  bgeu a2, a0, 2f
+    bltz a2, 2f
+    slli a2, a2, 1
+    slli a3, a3, 1
+    j 1b
+2:  bltu a0, a2, 3f
+    sub a0, a0, a2
+3:  srli a2, a2, 1
+    srli a3, a3, 1
+    bnez a3, 2b
+    ret
+
+rnd:
+    la t0, seed
+    lw a0, 0(t0)
+    slli t1, a0, 13
+    xor a0, a0, t1
+    srli t1, a0, 17
+    xor a0, a0, t1
+    slli t1, a0, 5
+    xor a0, a0, t1
+    sw a0, 0(t0)
+    ret
+
+hash:
+    srli t0, a0, 7
+    xor a0, a0, t0
+    slli t0, a0, 9
+    xor a0, a0, t0
+    srli t0, a0, 13
+    xor a0, a0, t0
+    slli a0, a0, 19
+    srli a0, a0, 19
+    ret
+
+insert:
+    addi sp, sp, -16
+    sw ra, 12(sp)
+    sw s0, 8(sp)
+    sw s1, 4(sp)
+    mv s0, a0
+    mv s1, a1
+    call hash
+    li t2, KEYS
+1:  slli t0, a0, 2
+    add t0, t0, t2
+    lw t1, 0(t0)
+    beqz t1, 2f
+    beq t1, s0, 2f
+    addi a0, a0, 1
+    slli a0, a0, 19
+    srli a0, a0, 19
+    j 1b
+2:  sw s0, 0(t0)
+    li t3, VALS - KEYS
+    add t3, t3, t0
+    lw t1, 0(t3)
+    add t1, t1, s1
+    sw t1, 0(t3)
+    lw ra, 12(sp)
+    lw s0, 8(sp)
+    lw s1, 4(sp)
+    addi sp, sp, 16
+    ret
+
+lookup:
+    addi sp, sp, -16
+    sw ra, 12(sp)
+    sw s0, 8(sp)
+    mv s0, a0
+    call hash
+    li t2, KEYS
+1:  slli t0, a0, 2
+    add t0, t0, t2
+    lw t1, 0(t0)
+    beqz t1, 3f
+    beq t1, s0, 2f
+    addi a0, a0, 1
+    slli a0, a0, 19
+    srli a0, a0, 19
+    j 1b
+2:  li t3, VALS - KEYS
+    add t3, t3, t0
+    lw a0, 0(t3)
+    j 4f
+3:  li a0, -1
+4:  lw ra, 12(sp)
+    lw s0, 8(sp)
+    addi sp, sp, 16
+    ret
+
+main:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    sw s1, 20(sp)
+    sw s2, 16(sp)
+    sw s3, 12(sp)
+    li s0, 6000
+    li s1, 0
+.Linsert:
+    call rnd
+    li t0, 16383
+    and a0, a0, t0
+    ori a0, a0, 1
+    andi a1, s1, 255
+    call insert
+    addi s1, s1, 1
+    bne s1, s0, .Linsert
+    li s0, 400000
+    li s1, 0
+    li s2, 0
+    li s3, 0
+.Llookup:
+    call rnd
+    li t0, 16383
+    and a0, a0, t0
+    ori a0, a0, 1
+    call lookup
+    bltz a0, 1f
+    addi s2, s2, 1
+    add s3, s3, a0
+1:  addi s1, s1, 1
+    bne s1, s0, .Llookup
+    slli a0, s2, 16
+    srli a0, a0, 16
+    call printInt
+    slli a0, s3, 16
+    srli a0, a0, 16
+    call printInt
+    la t0, judgeResult
+    lw a0, 0(t0)
+    li a1, 253
+    call __umodsi3
+    lw ra, 28(sp)
+    lw s0, 24(sp)
+    lw s1, 20(sp)
+    lw s2, 16(sp)
+    lw s3, 12(sp)
+    addi sp, sp, 32
+    ret
+
+    .org 0x8000
+judgeResult:
+    .word 0
+seed:
+    .word 88172645
@@ -0,0 +1,75 @@
+#include "io.inc"
+int nxt[512];
+int val[512];
+char text[256];
+unsigned seed = 521288629;
+
+unsigned rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+unsigned crc8(unsigned crc, unsigned data) {
+  for (int i = 0; i < 8; ++i) {
+    unsigned x = (data ^ crc) & 1;
+    data >>= 1;
+    crc >>= 1;
+    if (x) crc ^= 0xA001;
+  }
+  return crc;
+}
+
+int reverse(int head) {
+  int prev = -1;
+  while (head >= 0) {
+    int n = nxt[head];
+    nxt[head] = prev;
+    prev = head;
+    head = n;
+  }
+  return prev;
+}
+
+int scan() {
+  int state = 0, count = 0;
+  for (int i = 0; i < 256; ++i) {
+    int ch = text[i];
+    int next;
+    if (ch >= '0' && ch <= '9')
+      next = state == 2 ? 2 : 1;
+    else if (ch >= 'a' && ch <= 'z')
+      next = 2;
+    else
+      next = 0;
+    if (next != state) ++count;
+    state = next;
+  }
+  return count;
+}
+
+int main() {
+  for (int i = 0; i < 512; ++i) {
+    nxt[i] = i + 1 < 512 ? i + 1 : -1;
+    val[i] = rnd() & 65535;
+  }
+  for (int i = 0; i < 256; ++i) {
+    unsigned r = rnd() & 63;
+    text[i] = r < 26 ? 'a' + r : r < 46 ? '0' + (r - 26) % 10 : ' ';
+  }
+  unsigned crc = 0;
+  int head = 0, tokens = 0;
+  for (int it = 0; it < 1000; ++it) {
+    head = reverse(head);
+    for (int p = head; p >= 0; p = nxt[p]) {
+      crc = crc8(crc, val[p] & 255);
+      val[p] = (val[p] + (crc & 7)) & 65535;
+    }
+    text[it & 255] = 'a' + (crc & 15);
+    tokens += scan();
+  }
+  printInt(crc);
+  printInt(tokens & 65535);
+  return judgeResult % Mod;  // 56
+}
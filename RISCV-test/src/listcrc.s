@@ -0,0 +1,214 @@
+# Hand-written RV32I translation of listcrc.c.
+    .option norelax
+    .equ NXT, 0x10000
+    .equ VAL, 0x10800
+    .equ TEXT, 0x11000
+    .text
+    lui sp, 0x20
+    jal ra, main
+    li a2, 255
+    lui a3, 0x30
+    sb a2, 4(a3)
+1:  j 1b
+
+    .org 0x1000
+printInt:
+    la t0, judgeResult
+    lw t1, 0(t0)
+    xor t1, t1, a0
+    addi t1, t1, 173
+    sw t1, 0(t0)
+    ret
+
+__umodsi3:
+    mv a2, a1
+    li a3, 1
+1:  bgeu a2, a0, 2f
+    bltz a2, 2f
+    slli a2, a2, 1
+    slli a3, a3, 1
+    j 1b
+2:  bltu a0, a2, 3f
+    sub a0, a0, a2
+3:  srli a2, a2, 1
+    srli a3, a3, 1
+    bnez a3, 2b
+    ret
+
+rnd:
+    la t0, seed
+    lw a0, 0(t0)
+    slli t1, a0, 13
+    xor a0, a0, t1
+    srli t1, a0, 17
+    xor a0, a0, t1
+    slli t1, a0, 5
+    xor a0, a0, t1
+    sw a0, 0(t0)
+    ret
+
+crc8:
+    li t2, 8
+    li t3, 0xA001
+1:  xor t0, a1, a0
+    andi t0, t0, 1
+    srli a1, a1, 1
+    srli a0, a0, 1
+    beqz t0, 2f
+    xor a0, a0, t3
+2:  addi t2, t2, -1
+    bnez t2, 1b
+    ret
+
+reverse:
+    li t0, -1
+    li t2, NXT
+1:  bltz a0, 2f
+    slli t1, a0, 2
+    add t1, t1, t2
+    lw t3, 0(t1)
+    sw t0, 0(t1)
+    mv t0, a0
+    mv a0, t3
+    j 1b
+2:  mv a0, t0
+    ret
+
+scan:
+    li t0, 0
+    li a0, 0
+    li t1, TEXT
+    addi t2, t1, 256
+1:  lb t3, 0(t1)
+    addi t4, t3, -48
+    li t5, 10
+    bltu t4, t5, 2f
+    addi t4, t3, -97
+    li t5, 26
+    bltu t4, t5, 3f
+    li t6, 0
+    j 4f
+2:  li t6, 1
+    li t5, 2
+    bne t0, t5, 4f
+    li t6, 2
+    j 4f
+3:  li t6, 2
+4:  beq t6, t0, 5f
+    addi a0, a0, 1
+5:  mv t0, t6
+    addi t1, t1, 1
+    bne t1, t2, 1b
+    ret
+
+main:
+    addi sp, sp, -32
+    sw ra, 28(sp)
+    sw s0, 24(sp)
+    sw s1, 20(sp)
+    sw s2, 16(sp)
+    sw s3, 12(sp)
+    sw s4, 8(sp)
+    sw s5, 4(sp)
+    li s0, 0
+    li s1, NXT
+    li s2, VAL
+    li s3, 512
+1:  addi t0, s0, 1
+    bne t0, s3, 2f
+    li t0, -1
+2:  sw t0, 0(s1)
+    call rnd
+    slli a0, a0, 16
+    srli a0, a0, 16
+    sw a0, 0(s2)
+    addi s0, s0, 1
+    addi s1, s1, 4
+    addi s2, s2, 4
+    bne s0, s3, 1b
+    li s1, TEXT
+    addi s3, s1, 256
+1:  call rnd
+    andi a0, a0, 63
+    li t0, 26
+    bgeu a0, t0, 2f
+    addi a0, a0, 97
+    j 4f
+2:  li t0, 46
+    bgeu a0, t0, 3f
+    addi a0, a0, -26
+    li t0, 10
+    blt a0, t0, 5f
+    addi a0, a0, -10
+5:  addi a0, a0, 48
+    j 4f
+3:  li a0, 32
+4:  sb a0, 0(s1)
+    addi s1, s1, 1
+    bne s1, s3, 1b
+    li s0, 0
+    li s1, 0
+    li s2, 0
+    li s3, 0
+.Lloop:
+    mv a0, s1
+    call reverse
+    mv s1, a0
+    mv s4, s1
+.Lwalk:
+    bltz s4, .Lnext
+    slli s5, s4, 2
+    li t0, VAL
+    add s5, s5, t0
+    lw a1, 0(s5)
+    andi a1, a1, 255
+    mv a0, s0
+    call crc8
+    mv s0, a0
+    lw t0, 0(s5)
+    andi t1, s0, 7
+    add t0, t0, t1
+    slli t0, t0, 16
+    srli t0, t0, 16
+    sw t0, 0(s5)
+    slli t0, s4, 2
+    li t1, NXT
+    add t0, t0, t1
+    lw s4, 0(t0)
+    j .Lwalk
+.Lnext:
+    andi t0, s3, 255
+    li t1, TEXT
+    add t0, t0, t1
+    andi t1, s0, 15
+    addi t1, t1, 97
+    sb t1, 0(t0)
+    call scan
+    add s2, s2, a0
+    addi s3, s3, 1
+    li t0, 1000
+    bne s3, t0, .Lloop
+    mv a0, s0
+    call printInt
+    slli a0, s2, 16
+    srli a0, a0, 16
+    call printInt
+    la t0, judgeResult
+    lw a0, 0(t0)
+    li a1, 253
+    call __umodsi3
+    lw ra, 28(sp)
+    lw s0, 24(sp)
+    lw s1, 20(sp)
+    lw s2, 16(sp)
+    lw s3, 12(sp)
+    lw s4, 8(sp)
+    lw s5, 4(sp)
+    addi sp, sp, 32
+    ret
+
+    .org 0x8000
+judgeResult:
+    .word 0
+seed:
+    .word 521288629
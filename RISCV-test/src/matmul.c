@@ -0,0 +1,38 @@
+#include "io.inc"
+int a[64][64];
+int b[64][64];
+int c[64][64];
+unsigned seed = 12345;
+
+int next() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed & 255;
+}
+
+int main() {
+  for (int i = 0; i < 64; ++i)
+    for (int j = 0; j < 64; ++j)
+      a[i][j] = next();
+  for (int i = 0; i < 64; ++i)
+    for (int j = 0; j < 64; ++j)
+      b[i][j] = next();
+  for (int r = 0; r < 4; ++r) {
+    for (int i = 0; i < 64; ++i)
+      for (int j = 0; j < 64; ++j) {
+        int s = 0;
+        for (int k = 0; k < 64; ++k)
+          s += a[i][k] * b[k][j];
+        c[i][j] = s;
+      }
+    int sum = 0;
+    for (int i = 0; i < 64; ++i)
+      for (int j = 0; j < 64; ++j) {
+        sum ^= c[i][j];
+        a[i][j] = c[i][j] & 255;
+      }
+    printInt(sum & 65535);
+  }
+  return judgeResult % Mod;  // 228
+}
@@ -0,0 +1,145 @@
+# Hand-written RV32I translation of matmul.c.
+    .option norelax
+    .equ A, 0x20000
+    .equ B, 0x24000
+    .equ C, 0x28000
+    .text
+    lui sp, 0x20
+    jal ra, main
+    li a2, 255
+    lui a3, 0x30
+    sb a2, 4(a3)
+1:  j 1b
+
+    .org 0x1000
+printInt:
+    la t0, judgeResult
+    lw t1, 0(t0)
+    xor t1, t1, a0
+    addi t1, t1, 173
+    sw t1, 0(t0)
+    ret
+
+__mulsi3:
+    mv a2, a0
+    li a0, 0
+1:  andi a3, a1, 1
+    beqz a3, 2f
+    add a0, a0, a2
+2:  srli a1, a1, 1
+    slli a2, a2, 1
+    bnez a1, 1b
+    ret
+
+__umodsi3:
+    mv a2, a1
+    li a3, 1
+1:  bgeu a2, a0, 2f
+    bltz a2, 2f
+    slli a2, a2, 1
+    slli a3, a3, 1
+    j 1b
+2:  bltu a0, a2, 3f
+    sub a0, a0, a2
+3:  srli a2, a2, 1
+    srli a3, a3, 1
+    bnez a3, 2b
+    ret
+
+next:
+    la t0, seed
+    lw a0, 0(t0)
+    slli t1, a0, 13
+    xor a0, a0, t1
+    srli t1, a0, 17
+    xor a0, a0, t1
+    slli t1, a0, 5
+    xor a0, a0, t1
+    sw a0, 0(t0)
+    andi a0, a0, 255
+    ret
+
+main:
+    addi sp, sp, -48
+    sw ra, 44(sp)
+    sw s0, 40(sp)
+    sw s1, 36(sp)
+    sw s2, 32(sp)
+    sw s3, 28(sp)
+    sw s4, 24(sp)
+    sw s5, 20(sp)
+    sw s6, 16(sp)
+    sw s7, 12(sp)
+    li s0, A
+    li s1, C
+.Lfill:
+    call next
+    sw a0, 0(s0)
+    addi s0, s0, 4
+    bne s0, s1, .Lfill
+    li s6, 4
+.Lround:
+    li s0, A
+    li s2, C
+.Lrow:
+    li s1, 0
+.Lcol:
+    mv s3, s0
+    li s4, B
+    add s4, s4, s1
+    li s5, 0
+    addi s7, s0, 256
+.Lk:
+    lw a0, 0(s3)
+    lw a1, 0(s4)
+    call __mulsi3
+    add s5, s5, a0
+    addi s3, s3, 4
+    addi s4, s4, 256
+    bne s3, s7, .Lk
+    sw s5, 0(s2)
+    addi s2, s2, 4
+    addi s1, s1, 4
+    li t0, 256
+    bne s1, t0, .Lcol
+    addi s0, s0, 256
+    li t0, B
+    bne s0, t0, .Lrow
+    li s0, A
+    li s2, C
+    li s5, 0
+    li t1, C + 16384
+.Lsum:
+    lw t0, 0(s2)
+    xor s5, s5, t0
+    andi t0, t0, 255
+    sw t0, 0(s0)
+    addi s0, s0, 4
+    addi s2, s2, 4
+    bne s2, t1, .Lsum
+    slli a0, s5, 16
+    srli a0, a0, 16
+    call printInt
+    addi s6, s6, -1
+    bnez s6, .Lround
+    la t0, judgeResult
+    lw a0, 0(t0)
+    li a1, 253
+    call __umodsi3
+    lw ra, 44(sp)
+    lw s0, 40(sp)
+    lw s1, 36(sp)
+    lw s2, 32(sp)
+    lw s3, 28(sp)
+    lw s4, 24(sp)
+    lw s5, 20(sp)
+    lw s6, 16(sp)
+    lw s7, 12(sp)
+    addi sp, sp, 48
+    ret
+
+    .org 0x8000
+judgeResult:
+    .word 0
+seed:
+    .word 12345
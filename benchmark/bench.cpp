@@ -0,0 +1,327 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+using namespace std;
+
+struct Engine {
+    string name;
+    vector<string> argv;
+};
+
+struct Run {
+    double wall;
+    long rss;
+    unsigned long long cycles, insts;
+    string out;
+    bool ok;
+    map<string, double> host;
+};
+
+struct Result {
+    string engine, program;
+    double wall, startup;
+    long rss;
+    unsigned long long cycles, insts;
+    map<string, double> host;
+};
+
+double now_sec() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+string slurp(FILE * f) {
+    string ret;
+    char buf[4096];
+    size_t n;
+    rewind(f);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        ret.append(buf, n);
+    return ret;
+}
+
+unsigned long long field(const string & text, const string & key) {
+    size_t pos = text.rfind(key + ": ");
+    return pos == string::npos ? 0 : strtoull(text.c_str() + pos + key.size() + 2, NULL, 10);
+}
+
+map<string, double> host_counters(const string & text) {
+    map<string, double> ret;
+    istringstream is(text);
+    string line;
+    while (getline(is, line)) {
+        istringstream ls(line);
+        string tag, name;
+        double count, per;
+        if (ls >> tag >> name >> count >> per && tag == "host")
+            ret[name] = per;
+    }
+    return ret;
+}
+
+Run run(const Engine & e, const string & input) {
+    Run r = {0, 0, 0, 0, "", false, {}};
+    FILE * out = tmpfile(), * err = tmpfile();
+    int in = open(input.c_str(), O_RDONLY);
+    if (!out || !err || in < 0) {
+        if (out)
+            fclose(out);
+        if (err)
+            fclose(err);
+        if (in >= 0)
+            close(in);
+        return r;
+    }
+    vector<char *> args;
+    for (auto & a: e.argv)
+        args.push_back((char *) a.c_str());
+    args.push_back(NULL);
+    double start = now_sec();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(in, 0);
+        dup2(fileno(out), 1);
+        dup2(fileno(err), 2);
+        execvp(args[0], args.data());
+        _exit(127);
+    }
+    close(in);
+    int status;
+    rusage usage;
+    if (pid > 0 && wait4(pid, &status, 0, &usage) == pid) {
+        r.wall = now_sec() - start;
+        r.rss = usage.ru_maxrss;
+        r.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        r.out = slurp(out);
+        string text = slurp(err);
+        r.cycles = field(text, "cycles");
+        r.insts = field(text, "instructions");
+        r.host = host_counters(text);
+    }
+    fclose(out);
+    fclose(err);
+    return r;
+}
+
+string empty_image() {
+    char path[] = "/tmp/bench_empty_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return "";
+    const char * image = "@00000000\nb7 02 03 00 23 82 02 00\n";
+    ssize_t len = strlen(image);
+    bool ok = write(fd, image, len) == len;
+    close(fd);
+    return ok ? path : "";
+}
+
+vector<string> programs(const string & dir) {
+    vector<string> ret;
+    DIR * d = opendir(dir.c_str());
+    if (!d)
+        return ret;
+    while (dirent * ent = readdir(d)) {
+        string name = ent->d_name;
+        if (name.size() > 5 && name.compare(name.size() - 5, 5, ".data") == 0)
+            ret.push_back(name.substr(0, name.size() - 5));
+    }
+    closedir(d);
+    sort(ret.begin(), ret.end());
+    return ret;
+}
+
+string get_string(const string & line, const string & key) {
+    size_t pos = line.find("\"" + key + "\": \"");
+    if (pos == string::npos)
+        return "";
+    pos += key.size() + 5;
+    return line.substr(pos, line.find('"', pos) - pos);
+}
+
+double get_number(const string & line, const string & key) {
+    size_t pos = line.find("\"" + key + "\": ");
+    return pos == string::npos ? -1 : strtod(line.c_str() + pos + key.size() + 4, NULL);
+}
+
+void write_json(ostream & os, unsigned runs, const vector<Result> & results) {
+    os << "{\n  \"runs\": " << runs << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result & r = results[i];
+        os << "    {\"engine\": \"" << r.engine << "\", \"program\": \"" << r.program
+           << "\", \"wall_ms\": " << r.wall * 1e3 << ", \"startup_ms\": " << r.startup * 1e3
+           << ", \"rss_kb\": " << r.rss << ", \"cycles\": " << r.cycles
+           << ", \"instructions\": " << r.insts
+           << ", \"mips\": " << (r.wall > 0 ? r.insts / r.wall / 1e6 : 0)
+           << ", \"ns_per_cycle\": " << (r.cycles ? r.wall * 1e9 / r.cycles : 0);
+        for (auto & it: r.host)
+            os << ", \"host_" << it.first << "\": " << it.second;
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+bool compare(const char * file, const vector<Result> & results, double threshold) {
+    ifstream fin(file);
+    if (!fin) {
+        cerr << "cannot read baseline " << file << endl;
+        return false;
+    }
+    map<pair<string, string>, double> base;
+    string line;
+    while (getline(fin, line)) {
+        string engine = get_string(line, "engine"), program = get_string(line, "program");
+        double wall = get_number(line, "wall_ms");
+        if (!engine.empty() && !program.empty() && wall > 0)
+            base[{engine, program}] = wall;
+    }
+    bool ok = true;
+    map<string, pair<double, unsigned>> geo;
+    cout << fixed << setprecision(2);
+    for (const Result & r: results) {
+        auto it = base.find({r.engine, r.program});
+        if (it == base.end() || r.wall <= 0)
+            continue;
+        double ratio = r.wall * 1e3 / it->second;
+        geo[r.engine].first += log(ratio);
+        ++geo[r.engine].second;
+        if (ratio > 1 + threshold / 100) {
+            cout << "regression " << r.engine << "/" << r.program << ": " << it->second << " ms -> "
+                 << r.wall * 1e3 << " ms (+" << (ratio - 1) * 100 << "%)" << endl;
+            ok = false;
+        }
+    }
+    for (auto & it: geo)
+        cout << it.first << " geomean time ratio: " << exp(it.second.first / it.second.second)
+             << endl;
+    cout << defaultfloat;
+    return ok;
+}
+
+int main(int argc, char * argv[]) {
+    unsigned runs = 3;
+    const char * out_file = NULL, * base_file = NULL;
+    double threshold = 5;
+    vector<Engine> engines;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:b:t:e:")) != -1) {
+        switch (opt) {
+            case 'n': runs = strtoul(optarg, NULL, 0); break;
+            case 'o': out_file = optarg; break;
+            case 'b': base_file = optarg; break;
+            case 't': threshold = strtod(optarg, NULL); break;
+            case 'e': {
+                string spec = optarg;
+                size_t eq = spec.find('=');
+                Engine e;
+                e.name = spec.substr(0, eq);
+                istringstream is(eq == string::npos ? spec : spec.substr(eq + 1));
+                string arg;
+                while (is >> arg)
+                    e.argv.push_back(arg);
+                if (e.name.empty() || e.argv.empty()) {
+                    cerr << "-e expects name=command" << endl;
+                    return 1;
+                }
+                engines.push_back(e);
+                break;
+            }
+            default:
+                cerr << "usage: " << argv[0] << " [-n runs] [-o out.json] [-b baseline.json]"
+                     << " [-t percent] [-e name=command]... [testdir]" << endl;
+                return 1;
+        }
+    }
+    if (!runs)
+        runs = 1;
+    string dir = optind < argc ? argv[optind] : "RISCV-test/src";
+    if (engines.empty()) {
+        engines.push_back({"serial", {"./serial_simulator", "-v"}});
+        engines.push_back({"pipeline", {"./simulator", "-v"}});
+        engines.push_back({"dual", {"./simulator", "-v", "-d"}});
+    }
+    vector<string> progs = programs(dir);
+    if (progs.empty()) {
+        cerr << "no .data files in " << dir << endl;
+        return 1;
+    }
+    string empty = empty_image();
+
+    vector<Result> results;
+    map<string, string> expected;
+    map<string, unsigned long long> insts;
+    bool ok = true;
+    for (const Engine & e: engines) {
+        double startup = 0;
+        for (unsigned i = 0; i < runs && !empty.empty(); ++i) {
+            Run r = run(e, empty);
+            if (!r.ok)
+                break;
+            startup = i ? min(startup, r.wall) : r.wall;
+        }
+        cerr << e.name << ": startup " << fixed << setprecision(2) << startup * 1e3 << " ms"
+             << defaultfloat << endl;
+        for (const string & p: progs) {
+            vector<double> walls;
+            Run last;
+            long rss = 0;
+            for (unsigned i = 0; i < runs; ++i) {
+                last = run(e, dir + "/" + p + ".data");
+                if (!last.ok)
+                    break;
+                walls.push_back(last.wall);
+                rss = max(rss, last.rss);
+            }
+            if (walls.size() < runs) {
+                cerr << e.name << "/" << p << ": run failed" << endl;
+                ok = false;
+                continue;
+            }
+            string out = last.out.substr(0, last.out.find('\n'));
+            if (!expected.count(p))
+                expected[p] = out;
+            else if (expected[p] != out) {
+                cerr << e.name << "/" << p << ": output " << out << ", expected " << expected[p]
+                     << endl;
+                ok = false;
+            }
+            if (last.insts)
+                insts[p] = last.insts;
+            sort(walls.begin(), walls.end());
+            Result r = {e.name, p, walls[walls.size() / 2], startup, rss, last.cycles,
+                        last.insts ? last.insts : insts[p], last.host};
+            results.push_back(r);
+            cerr << "  " << left << setw(16) << p << right << fixed << setprecision(2)
+                 << setw(10) << r.wall * 1e3 << " ms" << setw(10)
+                 << (r.wall > 0 ? r.insts / r.wall / 1e6 : 0) << " MIPS" << setw(10)
+                 << (r.cycles ? r.wall * 1e9 / r.cycles : 0) << " ns/cycle" << setw(10) << r.rss
+                 << " KB" << defaultfloat << endl;
+        }
+    }
+    if (!empty.empty())
+        unlink(empty.c_str());
+
+    if (out_file) {
+        ofstream fout(out_file);
+        write_json(fout, runs, results);
+    } else
+        write_json(cout, runs, results);
+    if (base_file && !compare(base_file, results, threshold))
+        ok = false;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include "../parallel/Inst.hpp"
+#include "../parallel/Functional.hpp"
+using namespace std;
+
+const unsigned long long TARGET = 1 << 24;
+
+struct Branch {
+    unsigned pc;
+    bool taken;
+};
+
+volatile unsigned sink;
+
+template <class F>
+void bench(const char * name, unsigned long long ops, F body) {
+    body();
+    unsigned reps = 1;
+    while (ops * reps < TARGET)
+        reps <<= 1;
+    auto start = chrono::steady_clock::now();
+    for (unsigned r = 0; r < reps; ++r)
+        body();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double total = (double) ops * reps;
+    cout << left << setw(24) << name << right << fixed << setprecision(2)
+         << setw(10) << sec * 1e9 / total << " ns/op" << setw(12) << total / sec / 1e6
+         << " Mops/s" << defaultfloat << endl;
+}
+
+int main(int argc, char * argv[]) {
+    const char * file = argc > 1 ? argv[1] : "RISCV-test/src/queens.data";
+    if (!freopen(file, "r", stdin)) {
+        cerr << "cannot open " << file << endl;
+        return 1;
+    }
+    reg[0].set_zero();
+    pc.write(0);
+    ret = false;
+    mem.init();
+    for (int i = ID; i <= WB; ++i)
+        inst[i] = new NOP;
+
+    vector<unsigned> codes;
+    vector<Branch> branches;
+    vector<Inst *> window;
+    while (!ret && codes.size() < (1 << 20)) {
+        Inst * cur = run_inst();
+        codes.push_back(cur->code);
+        bool taken, miss;
+        if (cur->outcome(taken, miss) && cur->opcode() == 0x63)
+            branches.push_back({cur->inst_pc, taken});
+        if (window.size() < 4096)
+            window.push_back(cur);
+        else
+            delete cur;
+    }
+    cout << file << ": " << codes.size() << " instructions, " << branches.size() << " branches"
+         << endl;
+
+    bench("Inst::parse", codes.size(), [&] {
+        for (unsigned c: codes) {
+            Inst * p = Inst::parse(c);
+            sink += p->code;
+            delete p;
+        }
+    });
+
+    const unsigned N = 1 << 16, SPAN = 1 << 20;
+    vector<unsigned> seq(N), rnd(N);
+    mt19937 gen(1);
+    for (unsigned i = 0; i < N; ++i) {
+        seq[i] = i * 4 % SPAN;
+        rnd[i] = gen() % (Memory::SIZE - 4) & ~3U;
+    }
+    bench("read_dword sequential", N, [&] {
+        for (unsigned a: seq)
+            sink += mem.read_dword(a);
+    });
+    bench("read_dword random", N, [&] {
+        for (unsigned a: rnd)
+            sink += mem.read_dword(a);
+    });
+    bench("write_dword sequential", N, [&] {
+        unsigned i = 0;
+        for (unsigned a: seq)
+            mem.write_dword(a, ++i);
+    });
+    bench("write_dword random", N, [&] {
+        unsigned i = 0;
+        for (unsigned a: rnd)
+            mem.write_dword(a, ++i);
+    });
+
+    pred.clear();
+    if (!branches.empty())
+        bench("Predictor via pred", branches.size(), [&] {
+            for (const Branch & b: branches) {
+                sink += pred[b.pc].predict();
+                pred[b.pc].update(b.taken);
+            }
+        });
+
+    vector<unsigned> srcs;
+    for (unsigned i = 3; i < window.size(); ++i)
+        srcs.push_back(window[i]->rs1());
+    Inst * saved[5];
+    for (int i = ID; i <= WB; ++i)
+        saved[i] = inst[i];
+    SrcInst consumer;
+    if (!srcs.empty())
+        bench("SrcInst::get_fwd", srcs.size(), [&] {
+            for (unsigned i = 0; i < srcs.size(); ++i) {
+                inst[WB] = window[i];
+                inst[MEM] = window[i + 1];
+                inst[EX] = window[i + 2];
+                unsigned val = 0;
+                consumer.get_fwd(srcs[i], val);
+                sink += val;
+            }
+        });
+    for (int i = ID; i <= WB; ++i) {
+        inst[i] = saved[i];
+        delete inst[i];
+    }
+    for (Inst * p: window)
+        delete p;
+    return 0;
+}
@@ -0,0 +1,186 @@
+#ifndef DECODE_HPP
+#define DECODE_HPP 1
+
+enum Format {FMT_NONE, FMT_R, FMT_I, FMT_S, FMT_B, FMT_U, FMT_J};
+
+enum Op {
+    OP_ILLEGAL,
+    OP_LUI, OP_AUIPC, OP_JAL, OP_JALR,
+    OP_BEQ, OP_BNE, OP_BLT, OP_BGE, OP_BLTU, OP_BGEU,
+    OP_LB, OP_LH, OP_LW, OP_LBU, OP_LHU,
+    OP_SB, OP_SH, OP_SW,
+    OP_ADDI, OP_SLTI, OP_SLTIU, OP_XORI, OP_ORI, OP_ANDI, OP_SLLI, OP_SRLI, OP_SRAI,
+    OP_ADD, OP_SUB, OP_SLL, OP_SLT, OP_SLTU, OP_XOR, OP_SRL, OP_SRA, OP_OR, OP_AND,
+    OP_NUM
+};
+
+struct OpInfo {
+    Op op;
+    unsigned mask, match;
+    Format format;
+    const char * name;
+};
+
+const unsigned MASK_OPCODE = 0x7F;
+const unsigned MASK_FUNCT3 = 0x707F;
+const unsigned MASK_FUNCT7 = 0xFE00707F;
+
+constexpr OpInfo isa[OP_NUM] = {
+    {OP_ILLEGAL, 0, 0, FMT_NONE, "ILLEGAL"},
+    {OP_LUI, MASK_OPCODE, 0x37, FMT_U, "LUI"},
+    {OP_AUIPC, MASK_OPCODE, 0x17, FMT_U, "AUIPC"},
+    {OP_JAL, MASK_OPCODE, 0x6F, FMT_J, "JAL"},
+    {OP_JALR, MASK_FUNCT3, 0x67, FMT_I, "JALR"},
+    {OP_BEQ, MASK_FUNCT3, 0x0063, FMT_B, "BEQ"},
+    {OP_BNE, MASK_FUNCT3, 0x1063, FMT_B, "BNE"},
+    {OP_BLT, MASK_FUNCT3, 0x4063, FMT_B, "BLT"},
+    {OP_BGE, MASK_FUNCT3, 0x5063, FMT_B, "BGE"},
+    {OP_BLTU, MASK_FUNCT3, 0x6063, FMT_B, "BLTU"},
+    {OP_BGEU, MASK_FUNCT3, 0x7063, FMT_B, "BGEU"},
+    {OP_LB, MASK_FUNCT3, 0x0003, FMT_I, "LB"},
+    {OP_LH, MASK_FUNCT3, 0x1003, FMT_I, "LH"},
+    {OP_LW, MASK_FUNCT3, 0x2003, FMT_I, "LW"},
+    {OP_LBU, MASK_FUNCT3, 0x4003, FMT_I, "LBU"},
+    {OP_LHU, MASK_FUNCT3, 0x5003, FMT_I, "LHU"},
+    {OP_SB, MASK_FUNCT3, 0x0023, FMT_S, "SB"},
+    {OP_SH, MASK_FUNCT3, 0x1023, FMT_S, "SH"},
+    {OP_SW, MASK_FUNCT3, 0x2023, FMT_S, "SW"},
+    {OP_ADDI, MASK_FUNCT3, 0x0013, FMT_I, "ADDI"},
+    {OP_SLTI, MASK_FUNCT3, 0x2013, FMT_I, "SLTI"},
+    {OP_SLTIU, MASK_FUNCT3, 0x3013, FMT_I, "SLTIU"},
+    {OP_XORI, MASK_FUNCT3, 0x4013, FMT_I, "XORI"},
+    {OP_ORI, MASK_FUNCT3, 0x6013, FMT_I, "ORI"},
+    {OP_ANDI, MASK_FUNCT3, 0x7013, FMT_I, "ANDI"},
+    {OP_SLLI, MASK_FUNCT7, 0x00001013, FMT_I, "SLLI"},
+    {OP_SRLI, MASK_FUNCT7, 0x00005013, FMT_I, "SRLI"},
+    {OP_SRAI, MASK_FUNCT7, 0x40005013, FMT_I, "SRAI"},
+    {OP_ADD, MASK_FUNCT7, 0x00000033, FMT_R, "ADD"},
+    {OP_SUB, MASK_FUNCT7, 0x40000033, FMT_R, "SUB"},
+    {OP_SLL, MASK_FUNCT7, 0x00001033, FMT_R, "SLL"},
+    {OP_SLT, MASK_FUNCT7, 0x00002033, FMT_R, "SLT"},
+    {OP_SLTU, MASK_FUNCT7, 0x00003033, FMT_R, "SLTU"},
+    {OP_XOR, MASK_FUNCT7, 0x00004033, FMT_R, "XOR"},
+    {OP_SRL, MASK_FUNCT7, 0x00005033, FMT_R, "SRL"},
+    {OP_SRA, MASK_FUNCT7, 0x40005033, FMT_R, "SRA"},
+    {OP_OR, MASK_FUNCT7, 0x00006033, FMT_R, "OR"},
+    {OP_AND, MASK_FUNCT7, 0x00007033, FMT_R, "AND"},
+};
+
+const unsigned DECODE_BITS = 11;
+const unsigned KEY_MASK = 0x4000707F;
+
+constexpr unsigned decode_key(unsigned code) {
+    return (code & 0x7F) | (code >> 12 & 0x7) << 7 | (code >> 30 & 0x1) << 10;
+}
+
+constexpr unsigned key_code(unsigned key) {
+    return (key & 0x7F) | (key >> 7 & 0x7) << 12 | (key >> 10 & 0x1) << 30;
+}
+
+constexpr bool key_matches(unsigned key, const OpInfo & info) {
+    return ((key_code(key) ^ info.match) & info.mask & KEY_MASK) == 0;
+}
+
+struct DecodeTable {
+    unsigned char op[1 << DECODE_BITS];
+};
+
+constexpr DecodeTable make_decode_table() {
+    DecodeTable t = {};
+    for (unsigned key = 0; key < (1 << DECODE_BITS); ++key)
+        for (unsigned i = 1; i < OP_NUM; ++i)
+            if (key_matches(key, isa[i]))
+                t.op[key] = i;
+    return t;
+}
+
+constexpr bool isa_consistent() {
+    for (unsigned i = 0; i < OP_NUM; ++i)
+        if (isa[i].op != i || (isa[i].match & ~isa[i].mask))
+            return false;
+    for (unsigned key = 0; key < (1 << DECODE_BITS); ++key) {
+        unsigned hits = 0;
+        for (unsigned i = 1; i < OP_NUM; ++i)
+            hits += key_matches(key, isa[i]);
+        if (hits > 1)
+            return false;
+    }
+    return true;
+}
+
+static_assert(isa_consistent(), "instruction table out of order or ambiguous");
+
+constexpr DecodeTable decode_table = make_decode_table();
+
+inline Op decode(unsigned code) {
+    const OpInfo & info = isa[decode_table.op[decode_key(code)]];
+    return (code & info.mask) == info.match ? info.op : OP_ILLEGAL;
+}
+
+inline unsigned sgnext(unsigned imm, int hi) {
+    if (imm & (1 << hi))
+        imm |= 0xFFFFFFFF >> hi << hi;
+    return imm;
+}
+
+struct Fields {
+    unsigned rd, rs1, rs2, imm;
+};
+
+inline Fields fields(unsigned code, Format format) {
+    Fields f = {code >> 7 & 0x1F, code >> 15 & 0x1F, code >> 20 & 0x1F, 0};
+    switch (format) {
+        case FMT_I:
+            f.imm = sgnext(code >> 20, 11);
+            break;
+        case FMT_S:
+            f.imm = sgnext((code >> 7 & 0x1F) + ((code >> 25 & 0x7F) << 5), 11);
+            break;
+        case FMT_B:
+            f.imm = sgnext(((code >> 8 & 0xF) << 1) + ((code >> 25 & 0x3F) << 5) +
+                ((code >> 7 & 0x1) << 11) + ((code >> 31 & 1) << 12), 12);
+            break;
+        case FMT_U:
+            f.imm = code & 0xFFFFF000;
+            break;
+        case FMT_J:
+            f.imm = sgnext(((code >> 21 & 0x3FF) << 1) + ((code >> 20 & 0x1) << 11) +
+                ((code >> 12 & 0xFF) << 12) + ((code >> 31 & 0x1) << 20), 20);
+            break;
+        default:
+            break;
+    }
+    return f;
+}
+
+template <class Base, class T>
+Base * make_inst(unsigned code) {
+    T * ret = new T;
+    ret->set(fields(code, isa[T::op].format));
+    return ret;
+}
+
+template <class Base, class... T>
+class HandlerTable {
+    static_assert(sizeof...(T) == OP_NUM, "handler table needs one class per Op");
+private:
+    Base * (* make[OP_NUM])(unsigned);
+public:
+    constexpr HandlerTable(): make() {
+        Op op[] = {T::op...};
+        Base * (* ctor[])(unsigned) = {make_inst<Base, T>...};
+        for (unsigned i = 0; i < sizeof...(T); ++i)
+            make[op[i]] = ctor[i];
+    }
+    constexpr bool complete() const {
+        for (unsigned i = 0; i < OP_NUM; ++i)
+            if (!make[i])
+                return false;
+        return true;
+    }
+    Base * operator()(unsigned code) const {
+        return make[decode(code)](code);
+    }
+};
+
+#endif
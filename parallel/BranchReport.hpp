@@ -0,0 +1,79 @@
+#ifndef BRANCHREPORT_HPP
+#define BRANCHREPORT_HPP 1
+
+#include "Inst.hpp"
+#include "Symbol.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+
+class BranchReport {
+private:
+    struct Stat {
+        unsigned long long count, taken, miss, lost;
+    };
+    const SymbolTable & sym;
+    unsigned bits;
+    std::unordered_map<unsigned, Stat> stat;
+    unsigned index(unsigned pc) const {
+        return pc >> 2 & ((1U << bits) - 1);
+    }
+public:
+    BranchReport(const SymbolTable & sym, unsigned bits): sym(sym), bits(bits) {}
+    void account(Inst * wb) {
+        if (wb->cause == BRANCH_FLUSH || wb->cause == JALR_FLUSH) {
+            ++stat[wb->inst_pc].lost;
+            return;
+        }
+        bool taken, miss;
+        if (!wb->outcome(taken, miss))
+            return;
+        Stat & s = stat[wb->inst_pc];
+        ++s.count;
+        s.taken += taken;
+        s.miss += miss;
+    }
+    void report(std::ostream & os) {
+        std::vector<std::pair<unsigned, Stat>> list(stat.begin(), stat.end());
+        std::sort(list.begin(), list.end(),
+            [](const std::pair<unsigned, Stat> & a, const std::pair<unsigned, Stat> & b) {
+                return a.second.lost != b.second.lost ? a.second.lost > b.second.lost :
+                    a.first < b.first;
+            });
+        std::map<unsigned, std::vector<unsigned>> alias;
+        for (auto & it: list)
+            alias[index(it.first)].push_back(it.first);
+        unsigned long long lost = 0, miss = 0;
+        for (auto & it: list) {
+            lost += it.second.lost;
+            miss += it.second.miss;
+        }
+        os << "static branches: " << list.size() << ", mispredicts: " << miss
+           << ", cycles lost: " << lost << std::endl;
+        os << std::setw(8) << "pc" << "  " << std::left << std::setw(20) << "symbol" << std::right
+           << std::setw(12) << "count" << std::setw(9) << "taken%" << std::setw(12) << "mispredict"
+           << std::setw(9) << "miss%" << std::setw(12) << "lost" << "  aliases (" << (1U << bits)
+           << " entries)" << std::endl;
+        os << std::fixed << std::setprecision(2);
+        for (auto & it: list) {
+            const Stat & s = it.second;
+            os << std::hex << std::setw(8) << std::setfill('0') << it.first << std::dec
+               << std::setfill(' ') << "  " << std::left << std::setw(20) << sym.lookup(it.first)
+               << std::right << std::setw(12) << s.count
+               << std::setw(9) << (s.count ? s.taken * 100.0 / s.count : 0.0)
+               << std::setw(12) << s.miss
+               << std::setw(9) << (s.count ? s.miss * 100.0 / s.count : 0.0)
+               << std::setw(12) << s.lost << " ";
+            for (unsigned pc: alias[index(it.first)])
+                if (pc != it.first)
+                    os << " " << std::hex << pc << std::dec;
+            os << std::endl;
+        }
+        os << std::defaultfloat;
+    }
+};
+
+#endif
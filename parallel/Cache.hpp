@@ -0,0 +1,45 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP 1
+
+#include <vector>
+
+class Cache {
+private:
+    unsigned sets, ways, line_bits;
+    std::vector<unsigned> tag;
+    std::vector<unsigned long long> stamp;
+    unsigned long long now;
+public:
+    unsigned long long hits, misses;
+    Cache(unsigned size, unsigned ways, unsigned line): ways(ways), line_bits(0), now(0),
+        hits(0), misses(0) {
+        while ((1U << line_bits) < line)
+            ++line_bits;
+        sets = size / line / ways;
+        if (!sets)
+            sets = 1;
+        tag.assign(sets * ways, ~0U);
+        stamp.assign(sets * ways, 0);
+    }
+    bool access(unsigned addr) {
+        unsigned blk = addr >> line_bits;
+        unsigned base = blk % sets * ways;
+        unsigned victim = base;
+        ++now;
+        for (unsigned i = base; i < base + ways; ++i) {
+            if (tag[i] == blk) {
+                stamp[i] = now;
+                ++hits;
+                return true;
+            }
+            if (stamp[i] < stamp[victim])
+                victim = i;
+        }
+        tag[victim] = blk;
+        stamp[victim] = now;
+        ++misses;
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP 1
+
+#include "Inst.hpp"
+#include "Serialize.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+const unsigned CHECKPOINT_MAGIC = 0x54504B43;
+
+void save_state(std::ostream & os) {
+    put(os, cycle);
+    put(os, instret);
+    put(os, branch);
+    put(os, correct);
+    unsigned val = pc.read();
+    put(os, val);
+    for (int i = 0; i < 32; ++i) {
+        val = reg[i].read();
+        put(os, val);
+    }
+    unsigned cnt = pred.size();
+    put(os, cnt);
+    for (auto & it: pred) {
+        put(os, it.first);
+        it.second.save(os);
+    }
+    for (int i = ID; i <= WB; ++i) {
+        put(os, inst[i]->code);
+        put(os, inst[i]->inst_pc);
+        inst[i]->save(os);
+    }
+    mem.save(os);
+}
+
+void load_state(std::istream & is) {
+    get(is, cycle);
+    get(is, instret);
+    get(is, branch);
+    get(is, correct);
+    unsigned val;
+    get(is, val);
+    pc.write(val);
+    for (int i = 0; i < 32; ++i) {
+        get(is, val);
+        reg[i].write(val);
+    }
+    unsigned cnt;
+    get(is, cnt);
+    pred.clear();
+    for (unsigned i = 0; i < cnt; ++i) {
+        get(is, val);
+        pred[val].load(is);
+    }
+    for (int i = ID; i <= WB; ++i) {
+        get(is, val);
+        delete inst[i];
+        inst[i] = val ? Inst::parse(val) : new NOP;
+        get(is, inst[i]->inst_pc);
+        inst[i]->load(is);
+    }
+    mem.load(is);
+}
+
+void save_checkpoint(std::ostream & os) {
+    std::ostringstream buf;
+    save_state(buf);
+    const std::string & data = buf.str();
+    unsigned len = data.size();
+    put(os, CHECKPOINT_MAGIC);
+    put(os, len);
+    os.write(data.data(), len);
+    os.flush();
+}
+
+bool load_checkpoint(std::istream & is) {
+    unsigned magic, len;
+    get(is, magic);
+    get(is, len);
+    if (!is || magic != CHECKPOINT_MAGIC)
+        return false;
+    std::string data(len, 0);
+    is.read(&data[0], len);
+    if (!is)
+        return false;
+    std::istringstream buf(data);
+    load_state(buf);
+    return true;
+}
+
+#endif
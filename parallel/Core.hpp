@@ -0,0 +1,369 @@
+#ifndef CORE_HPP
+#define CORE_HPP 1
+
+#include "Inst.hpp"
+#include "Cache.hpp"
+#include "../common/Decode.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+struct Slot {
+    unsigned code, addr;
+    Op op;
+    unsigned rd, rs1, rs2, imm;
+    unsigned lhs, rhs, ans, maddr, pred_pc;
+};
+
+inline bool is_load(Op op) {
+    return op >= OP_LB && op <= OP_LHU;
+}
+
+inline bool is_store(Op op) {
+    return op >= OP_SB && op <= OP_SW;
+}
+
+inline bool is_branch(Op op) {
+    return op >= OP_BEQ && op <= OP_BGEU;
+}
+
+enum Bypass {FROM_REG, FROM_EX, FROM_MEM, NOT_READY};
+
+class LocalPredictor {
+public:
+    bool predict(unsigned addr, unsigned imm) {
+        return pred[addr].predict();
+    }
+    void update(unsigned addr, bool taken) {
+        pred[addr].update(taken);
+    }
+};
+
+class NotTaken {
+public:
+    bool predict(unsigned addr, unsigned imm) {
+        return false;
+    }
+    void update(unsigned addr, bool taken) {}
+};
+
+class BackwardTaken {
+public:
+    bool predict(unsigned addr, unsigned imm) {
+        return imm >> 31;
+    }
+    void update(unsigned addr, bool taken) {}
+};
+
+class NoCache {
+public:
+    unsigned access(unsigned addr) {
+        return 0;
+    }
+    void report(std::ostream & os, const char * name) {}
+};
+
+template <unsigned SIZE, unsigned WAYS, unsigned LINE, unsigned PENALTY>
+class BlockingCache {
+private:
+    Cache cache;
+public:
+    BlockingCache(): cache(SIZE, WAYS, LINE) {}
+    unsigned access(unsigned addr) {
+        return cache.access(addr) ? 0 : PENALTY;
+    }
+    void report(std::ostream & os, const char * name) {
+        unsigned long long total = cache.hits + cache.misses;
+        os << name << " misses: " << cache.misses;
+        if (total)
+            os << " (" << cache.misses * 100.0 / total << "%)";
+        os << std::endl;
+    }
+};
+
+class FullForwarding {
+public:
+    static Bypass read(const Slot & ex, const Slot & mem, unsigned src, unsigned & val) {
+        if (!src)
+            return FROM_REG;
+        if (ex.rd == src) {
+            if (is_load(ex.op))
+                return NOT_READY;
+            val = ex.ans;
+            return FROM_EX;
+        }
+        if (mem.rd == src) {
+            val = mem.ans;
+            return FROM_MEM;
+        }
+        return FROM_REG;
+    }
+};
+
+class NoForwarding {
+public:
+    static Bypass read(const Slot & ex, const Slot & mem, unsigned src, unsigned & val) {
+        return src && (ex.rd == src || mem.rd == src) ? NOT_READY : FROM_REG;
+    }
+};
+
+class NoStats {
+public:
+    void retire(Op op) {}
+    void stall() {}
+    void flush() {}
+    void bypass(Bypass b) {}
+    void mem_stall(unsigned cycles) {}
+    void report(std::ostream & os) {}
+};
+
+class PipelineStats {
+private:
+    unsigned long long stalls, flushes, loads, stores, mem_stalls;
+    unsigned long long bypasses[NOT_READY];
+public:
+    PipelineStats(): stalls(0), flushes(0), loads(0), stores(0), mem_stalls(0),
+        bypasses{0, 0, 0} {}
+    void retire(Op op) {
+        loads += is_load(op);
+        stores += is_store(op);
+    }
+    void stall() {
+        ++stalls;
+    }
+    void flush() {
+        ++flushes;
+    }
+    void bypass(Bypass b) {
+        if (b != NOT_READY)
+            ++bypasses[b];
+    }
+    void mem_stall(unsigned cycles) {
+        mem_stalls += cycles;
+    }
+    void report(std::ostream & os) {
+        os << "stalls: " << stalls << std::endl;
+        os << "flushes: " << flushes << std::endl;
+        os << "memory stall cycles: " << mem_stalls << std::endl;
+        os << "loads: " << loads << std::endl;
+        os << "stores: " << stores << std::endl;
+        os << "forwarded from ex: " << bypasses[FROM_EX] << std::endl;
+        os << "forwarded from mem: " << bypasses[FROM_MEM] << std::endl;
+    }
+};
+
+class CoreBase {
+protected:
+    std::string fault;
+public:
+    const std::string & error() const {
+        return fault;
+    }
+    virtual void run(unsigned long long limit) = 0;
+    virtual void report(std::ostream & os) = 0;
+    virtual ~CoreBase() {}
+};
+
+template <class Pred, class ICache, class DCache, class Forwarding, class Stat>
+class Core: public CoreBase {
+private:
+    Pred bp;
+    ICache icache;
+    DCache dcache;
+    Stat stat;
+    Slot st[5];
+
+    static Slot nop() {
+        Slot s = {};
+        s.op = OP_ADDI;
+        return s;
+    }
+    void wait(unsigned cycles) {
+        cycle += cycles;
+        stat.mem_stall(cycles);
+    }
+    void fetch(Slot & s) {
+        unsigned cur_pc = pc.read();
+        wait(icache.access(cur_pc));
+        s.code = mem.read_dword(cur_pc);
+        s.addr = cur_pc;
+        s.op = decode(s.code);
+        Format fmt = isa[s.op].format;
+        Fields f = fields(s.code, fmt);
+        s.rd = fmt == FMT_NONE || fmt == FMT_S || fmt == FMT_B ? 0 : f.rd;
+        s.rs1 = fmt == FMT_NONE || fmt == FMT_U || fmt == FMT_J ? 0 : f.rs1;
+        s.rs2 = fmt == FMT_R || fmt == FMT_S || fmt == FMT_B ? f.rs2 : 0;
+        s.imm = f.imm;
+        unsigned next = cur_pc + 4;
+        if (s.op == OP_JAL || (is_branch(s.op) && bp.predict(cur_pc, s.imm)))
+            next = cur_pc + s.imm;
+        s.pred_pc = next;
+        pc.write(next);
+    }
+    bool decode_regs(Slot & s) {
+        s.lhs = reg[s.rs1].read();
+        s.rhs = reg[s.rs2].read();
+        Bypass b1 = Forwarding::read(st[MEM], st[WB], s.rs1, s.lhs);
+        Bypass b2 = Forwarding::read(st[MEM], st[WB], s.rs2, s.rhs);
+        stat.bypass(b1);
+        stat.bypass(b2);
+        return b1 != NOT_READY && b2 != NOT_READY;
+    }
+    bool redirect(Slot & s, unsigned next) {
+        if (next == s.pred_pc)
+            return false;
+        pc.write(next);
+        return true;
+    }
+    bool resolve(Slot & s, bool taken) {
+        ++branch;
+        bp.update(s.addr, taken);
+        if (redirect(s, s.addr + (taken ? s.imm : 4)))
+            return true;
+        ++correct;
+        return false;
+    }
+    bool execute(Slot & s) {
+        unsigned a = s.lhs, b = s.rhs, imm = s.imm;
+        switch (s.op) {
+            case OP_LUI: s.ans = imm; break;
+            case OP_AUIPC: s.ans = s.addr + imm; break;
+            case OP_JAL: s.ans = s.addr + 4; break;
+            case OP_JALR:
+                s.ans = s.addr + 4;
+                return redirect(s, (a + imm) >> 1 << 1);
+            case OP_BEQ: return resolve(s, a == b);
+            case OP_BNE: return resolve(s, a != b);
+            case OP_BLT: return resolve(s, (int) a < (int) b);
+            case OP_BGE: return resolve(s, (int) a >= (int) b);
+            case OP_BLTU: return resolve(s, a < b);
+            case OP_BGEU: return resolve(s, a >= b);
+            case OP_LB: case OP_LH: case OP_LW: case OP_LBU: case OP_LHU:
+            case OP_SB: case OP_SH: case OP_SW:
+                s.maddr = a + imm;
+                break;
+            case OP_ADDI: s.ans = a + imm; break;
+            case OP_SLTI: s.ans = (int) a < (int) imm; break;
+            case OP_SLTIU: s.ans = a < imm; break;
+            case OP_XORI: s.ans = a ^ imm; break;
+            case OP_ORI: s.ans = a | imm; break;
+            case OP_ANDI: s.ans = a & imm; break;
+            case OP_SLLI: s.ans = a << (imm & 0x1F); break;
+            case OP_SRLI: s.ans = a >> (imm & 0x1F); break;
+            case OP_SRAI: s.ans = (int) a >> (imm & 0x1F); break;
+            case OP_ADD: s.ans = a + b; break;
+            case OP_SUB: s.ans = a - b; break;
+            case OP_SLL: s.ans = a << (b & 0x1F); break;
+            case OP_SLT: s.ans = (int) a < (int) b; break;
+            case OP_SLTU: s.ans = a < b; break;
+            case OP_XOR: s.ans = a ^ b; break;
+            case OP_SRL: s.ans = a >> (b & 0x1F); break;
+            case OP_SRA: s.ans = (int) a >> (b & 0x1F); break;
+            case OP_OR: s.ans = a | b; break;
+            case OP_AND: s.ans = a & b; break;
+            default: break;
+        }
+        return false;
+    }
+    void mem_access(Slot & s) {
+        if (is_load(s.op) || is_store(s.op))
+            wait(dcache.access(s.maddr));
+        switch (s.op) {
+            case OP_LB: s.ans = sgnext(mem.read(s.maddr), 7); break;
+            case OP_LH: s.ans = sgnext(mem.read_word(s.maddr), 15); break;
+            case OP_LW: s.ans = mem.read_dword(s.maddr); break;
+            case OP_LBU: s.ans = mem.read(s.maddr); break;
+            case OP_LHU: s.ans = mem.read_word(s.maddr); break;
+            case OP_SB: mem.write(s.maddr, s.rhs); break;
+            case OP_SH: mem.write_word(s.maddr, s.rhs); break;
+            case OP_SW: mem.write_dword(s.maddr, s.rhs); break;
+            default: return;
+        }
+        if (is_store(s.op))
+            ret = s.maddr == 0x30004;
+    }
+    void write_back(Slot & s) {
+        if (s.op == OP_ILLEGAL) {
+            std::ostringstream os;
+            os << "illegal instruction " << std::hex << s.code << " at " << s.addr;
+            fault = os.str();
+            return;
+        }
+        if (!s.code)
+            return;
+        ++instret;
+        stat.retire(s.op);
+        if (s.rd)
+            reg[s.rd].write(s.ans);
+    }
+    void tick() {
+        write_back(st[WB]);
+        mem_access(st[MEM]);
+        bool flush = execute(st[EX]);
+        st[WB] = st[MEM];
+        st[MEM] = st[EX];
+        if (flush) {
+            stat.flush();
+            st[EX] = st[ID] = nop();
+        } else if (!decode_regs(st[ID])) {
+            stat.stall();
+            st[EX] = nop();
+        } else {
+            st[EX] = st[ID];
+            fetch(st[ID]);
+        }
+        ++cycle;
+    }
+public:
+    Core() {
+        for (int i = IF; i <= WB; ++i)
+            st[i] = nop();
+    }
+    void run(unsigned long long limit) {
+        while (!ret && fault.empty() && cycle < limit)
+            tick();
+    }
+    void report(std::ostream & os) {
+        icache.report(os, "icache");
+        dcache.report(os, "dcache");
+        stat.report(os);
+    }
+};
+
+typedef BlockingCache<16384, 2, 64, 10> SmallICache;
+typedef BlockingCache<16384, 4, 64, 10> SmallDCache;
+
+template <class C>
+CoreBase * make_core() {
+    return new C;
+}
+
+struct CoreConfig {
+    const char * name;
+    CoreBase * (* make)();
+};
+
+const CoreConfig core_configs[] = {
+    {"base", make_core<Core<LocalPredictor, NoCache, NoCache, FullForwarding, NoStats>>},
+    {"stats", make_core<Core<LocalPredictor, NoCache, NoCache, FullForwarding, PipelineStats>>},
+    {"nottaken", make_core<Core<NotTaken, NoCache, NoCache, FullForwarding, PipelineStats>>},
+    {"btfn", make_core<Core<BackwardTaken, NoCache, NoCache, FullForwarding, PipelineStats>>},
+    {"noforward", make_core<Core<LocalPredictor, NoCache, NoCache, NoForwarding, PipelineStats>>},
+    {"cache", make_core<Core<LocalPredictor, SmallICache, SmallDCache, FullForwarding,
+                             PipelineStats>>},
+};
+
+CoreBase * make_core(const std::string & name) {
+    for (const CoreConfig & c: core_configs)
+        if (name == c.name)
+            return c.make();
+    return NULL;
+}
+
+void core_names(std::ostream & os) {
+    for (const CoreConfig & c: core_configs)
+        os << " " << c.name;
+    os << std::endl;
+}
+
+#endif
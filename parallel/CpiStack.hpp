@@ -0,0 +1,84 @@
+#ifndef CPISTACK_HPP
+#define CPISTACK_HPP 1
+
+#include "Inst.hpp"
+#include "Symbol.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class CpiStack {
+private:
+    struct Region {
+        std::string name;
+        unsigned long long retired;
+        unsigned long long cycles[CAUSE_NUM];
+    };
+    const SymbolTable & sym;
+    std::vector<Region> regions;
+    std::unordered_map<unsigned, unsigned> index;
+    unsigned lo, hi, cur;
+    unsigned region(unsigned addr) {
+        if (addr >= lo && addr < hi)
+            return cur;
+        lo = sym.start(addr);
+        hi = sym.end(addr);
+        auto it = index.find(lo);
+        if (it == index.end()) {
+            it = index.emplace(lo, regions.size()).first;
+            regions.push_back(Region());
+            regions.back().name = sym.lookup(addr);
+            regions.back().retired = 0;
+            for (int i = 0; i < CAUSE_NUM; ++i)
+                regions.back().cycles[i] = 0;
+        }
+        return cur = it->second;
+    }
+    void print(std::ostream & os, const Region & r) {
+        os << std::left << std::setw(24) << r.name << std::right;
+        unsigned long long total = 0;
+        for (int i = 0; i < CAUSE_NUM; ++i)
+            total += r.cycles[i];
+        os << std::setw(12) << r.retired << std::setw(12) << total;
+        for (int i = 0; i < CAUSE_NUM; ++i)
+            os << std::setw(10) << (r.retired ? (double) r.cycles[i] / r.retired : 0.0);
+        os << std::endl;
+    }
+public:
+    CpiStack(const SymbolTable & sym): sym(sym), lo(1), hi(0), cur(0) {}
+    void account(Inst * wb) {
+        Region & r = regions[region(wb->inst_pc)];
+        ++r.cycles[wb->cause];
+        if (wb->code)
+            ++r.retired;
+    }
+    void report(std::ostream & os) {
+        static const char * name[CAUSE_NUM] = {
+            "retire", "load_use", "branch", "jalr", "memory", "fill"
+        };
+        Region all;
+        all.name = "total";
+        all.retired = 0;
+        for (int i = 0; i < CAUSE_NUM; ++i)
+            all.cycles[i] = 0;
+        for (auto & r: regions) {
+            all.retired += r.retired;
+            for (int i = 0; i < CAUSE_NUM; ++i)
+                all.cycles[i] += r.cycles[i];
+        }
+        os << std::fixed << std::setprecision(4);
+        os << std::left << std::setw(24) << "region" << std::right
+           << std::setw(12) << "insts" << std::setw(12) << "cycles";
+        for (int i = 0; i < CAUSE_NUM; ++i)
+            os << std::setw(10) << name[i];
+        os << std::endl;
+        print(os, all);
+        for (auto & r: regions)
+            print(os, r);
+        os << std::defaultfloat;
+    }
+};
+
+#endif
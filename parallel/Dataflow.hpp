@@ -0,0 +1,124 @@
+#ifndef DATAFLOW_HPP
+#define DATAFLOW_HPP 1
+
+#include "Inst.hpp"
+#include "Symbol.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+
+struct DataflowConfig {
+    unsigned alu = 1;
+    unsigned load = 2;
+    unsigned store = 1;
+    unsigned branch = 1;
+};
+
+class Dataflow {
+private:
+    struct Value {
+        unsigned long long time, local, run;
+    };
+    struct FuncStat {
+        unsigned long long insts, visits, path;
+    };
+    DataflowConfig cfg;
+    const SymbolTable & sym;
+    Value regs[32];
+    std::unordered_map<unsigned, Value> words;
+    std::map<unsigned, FuncStat> funcs;
+    unsigned long long insts, critical, run, run_path;
+    unsigned func;
+    void depend(const Value & v, unsigned long long & time, unsigned long long & local) {
+        time = std::max(time, v.time);
+        if (v.run == run)
+            local = std::max(local, v.local);
+    }
+    void close() {
+        if (!run_path)
+            return;
+        FuncStat & f = funcs[func];
+        ++f.visits;
+        f.path += run_path;
+        run_path = 0;
+    }
+public:
+    Dataflow(const SymbolTable & sym, const DataflowConfig & cfg): cfg(cfg), sym(sym), insts(0),
+        critical(0), run(1), run_path(0), func(0) {
+        for (int i = 0; i < 32; ++i)
+            regs[i] = Value{0, 0, 0};
+    }
+    void account(Inst * wb) {
+        if (!wb->code)
+            return;
+        unsigned f = sym.start(wb->inst_pc);
+        if (f != func) {
+            close();
+            func = f;
+            ++run;
+        }
+        unsigned long long time = 0, local = 0, lat;
+        unsigned op = wb->opcode(), rd = wb->rd();
+        depend(regs[wb->rs1()], time, local);
+        depend(regs[wb->rs2()], time, local);
+        unsigned first = 0, last = 0;
+        if (op == 0x3 || op == 0x23) {
+            unsigned addr = wb->mem_addr();
+            first = addr >> 2;
+            last = (addr + (1 << (wb->code >> 12 & 0x3)) - 1) >> 2;
+        }
+        if (op == 0x3) {
+            lat = cfg.load;
+            for (unsigned w = first; w <= last; ++w) {
+                auto it = words.find(w);
+                if (it != words.end())
+                    depend(it->second, time, local);
+            }
+        } else if (op == 0x23)
+            lat = cfg.store;
+        else if (op == 0x63 || op == 0x67 || op == 0x6F)
+            lat = cfg.branch;
+        else
+            lat = cfg.alu;
+        Value done{time + lat, local + lat, run};
+        if (rd)
+            regs[rd] = done;
+        if (op == 0x23)
+            for (unsigned w = first; w <= last; ++w)
+                words[w] = done;
+        critical = std::max(critical, done.time);
+        run_path = std::max(run_path, done.local);
+        ++funcs[func].insts;
+        ++insts;
+    }
+    void report(std::ostream & os) {
+        close();
+        os << "instructions: " << insts << std::endl;
+        os << "critical path: " << critical << std::endl;
+        if (critical)
+            os << "ILP: " << (double) insts / critical << std::endl;
+        if (sym.empty())
+            return;
+        std::vector<std::pair<unsigned, FuncStat>> list(funcs.begin(), funcs.end());
+        std::sort(list.begin(), list.end(),
+            [](const std::pair<unsigned, FuncStat> & a, const std::pair<unsigned, FuncStat> & b) {
+                return a.second.insts > b.second.insts;
+            });
+        os << std::left << std::setw(24) << "function" << std::right << std::setw(14) << "insts"
+           << std::setw(12) << "visits" << std::setw(14) << "path" << std::setw(9) << "ILP"
+           << std::endl;
+        os << std::fixed << std::setprecision(2);
+        for (auto & it: list) {
+            const FuncStat & s = it.second;
+            os << std::left << std::setw(24) << sym.lookup(it.first) << std::right
+               << std::setw(14) << s.insts << std::setw(12) << s.visits << std::setw(14) << s.path
+               << std::setw(9) << (s.path ? (double) s.insts / s.path : 0.0) << std::endl;
+        }
+        os << std::defaultfloat;
+    }
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef DUALISSUE_HPP
+#define DUALISSUE_HPP 1
+
+#include "Inst.hpp"
+#include <iostream>
+
+enum Pairing {PAIRED, CONTROL, MEM_PORT, DEPENDENCY, PAIRING_NUM};
+
+thread_local unsigned long long pairing[PAIRING_NUM];
+
+bool is_control(Inst * cur) {
+    unsigned op = cur->opcode();
+    return op == 0x63 || op == 0x67 || op == 0x6F;
+}
+
+bool is_mem(Inst * cur) {
+    unsigned op = cur->opcode();
+    return op == 0x3 || op == 0x23;
+}
+
+Pairing can_pair(Inst * older, Inst * younger) {
+    if (is_control(older))
+        return CONTROL;
+    if (is_mem(older) && is_mem(younger))
+        return MEM_PORT;
+    unsigned rd = older->rd();
+    if (rd && (younger->rs1() == rd || younger->rs2() == rd))
+        return DEPENDENCY;
+    return PAIRED;
+}
+
+void fetch_pair() {
+    inst[IF] = Inst::parse(mem.read_dword(pc.read()));
+    inst[IF]->inst_pc = pc.read();
+    inst[IF]->pc_modify();
+    inst2[IF] = Inst::parse(mem.read_dword(pc.read()));
+    inst2[IF]->inst_pc = pc.read();
+    Pairing res = can_pair(inst[IF], inst2[IF]);
+    ++pairing[res];
+    if (res == PAIRED)
+        inst2[IF]->pc_modify();
+    else {
+        delete inst2[IF];
+        inst2[IF] = new NOP;
+    }
+    inst[ID] = inst[IF];
+    inst2[ID] = inst2[IF];
+}
+
+void tick_dual() {
+    stall = false;
+    bubble = false;
+    for (Inst * cur: {inst[WB], inst2[WB]})
+        if (cur->code) {
+            ++instret;
+            COUNT_RETIRE(cur->code);
+        }
+    inst[WB]->write_back();
+    inst2[WB]->write_back();
+    delete inst[WB];
+    delete inst2[WB];
+    inst[MEM]->mem_access();
+    inst2[MEM]->mem_access();
+    inst[WB] = inst[MEM];
+    inst2[WB] = inst2[MEM];
+    inst[EX]->execute();
+    inst2[EX]->execute();
+    inst[MEM] = inst[EX];
+    inst2[MEM] = inst2[EX];
+    if (bubble) {
+        COUNT(BUBBLES);
+        delete inst[ID];
+        delete inst2[ID];
+        Inst * br = inst2[MEM]->code ? inst2[MEM] : inst[MEM];
+        Cause cause = br->opcode() == 0x67 ? JALR_FLUSH : BRANCH_FLUSH;
+        inst[EX] = new NOP(cause, br->inst_pc);
+        inst2[EX] = new NOP(cause, br->inst_pc);
+        inst[ID] = new NOP(cause, br->inst_pc);
+        inst2[ID] = new NOP(cause, br->inst_pc);
+    } else {
+        inst[ID]->inst_decode();
+        inst2[ID]->inst_decode();
+        if (stall) {
+            COUNT(STALLS);
+            Inst * ld = inst2[MEM]->opcode() == 0x3 ? inst2[MEM] : inst[MEM];
+            inst[EX] = new NOP(LOAD_USE, ld->inst_pc);
+            inst2[EX] = new NOP(LOAD_USE, ld->inst_pc);
+        } else {
+            inst[EX] = inst[ID];
+            inst2[EX] = inst2[ID];
+            fetch_pair();
+        }
+    }
+    ++cycle;
+}
+
+void report_dual(std::ostream & os) {
+    static const char * name[PAIRING_NUM] = {"paired", "control", "mem_port", "dependency"};
+    unsigned long long groups = 0;
+    for (int i = 0; i < PAIRING_NUM; ++i)
+        groups += pairing[i];
+    os << "cycles: " << cycle << std::endl;
+    os << "instructions: " << instret << std::endl;
+    if (cycle)
+        os << "IPC: " << (double) instret / cycle << std::endl;
+    if (groups)
+        os << "dual-issue rate: " << (double) pairing[PAIRED] / groups * 100 << "%" << std::endl;
+    for (int i = CONTROL; i < PAIRING_NUM; ++i)
+        os << "pairing " << name[i] << ": " << pairing[i] << std::endl;
+}
+
+#endif
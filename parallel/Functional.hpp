@@ -0,0 +1,33 @@
+#ifndef FUNCTIONAL_HPP
+#define FUNCTIONAL_HPP 1
+
+#include "Inst.hpp"
+
+Inst * run_inst() {
+    bubble = false;
+    unsigned code = mem.read_dword(pc.read());
+    Inst * cur = Inst::parse(code);
+    cur->inst_pc = pc.read();
+    cur->pc_modify();
+    cur->inst_decode();
+    cur->execute();
+    cur->mem_access();
+    cur->write_back();
+    if (!ret) {
+        ++instret;
+        COUNT_RETIRE(code);
+    }
+    return cur;
+}
+
+void step() {
+    delete run_inst();
+}
+
+void fast_forward(unsigned long long num) {
+    unsigned long long end = instret + num;
+    while (!ret && instret < end)
+        step();
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef HEATMAP_HPP
+#define HEATMAP_HPP 1
+
+#include "Inst.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+class Heatmap {
+public:
+    static const unsigned LINE_BITS = 6;
+    static const unsigned LINE_NUM = Memory::SIZE >> LINE_BITS;
+    static const unsigned COLUMNS = 64;
+private:
+    enum Kind {READ, WRITE, FETCH, KIND_NUM};
+    struct LineStat {
+        unsigned count[KIND_NUM];
+        unsigned long long first, last;
+    };
+    std::vector<LineStat> lines;
+    std::vector<unsigned> heat;
+    unsigned shift;
+    void hit(unsigned addr, Kind kind, unsigned long long now) {
+        LineStat & l = lines[(addr >> LINE_BITS) & (LINE_NUM - 1)];
+        if (!(l.count[READ] | l.count[WRITE] | l.count[FETCH]))
+            l.first = now;
+        l.last = now;
+        ++l.count[kind];
+        while ((now >> shift) >= COLUMNS) {
+            for (unsigned p = 0; p < Memory::PAGE_NUM; ++p) {
+                unsigned * row = &heat[p * COLUMNS];
+                for (unsigned c = 0; c < COLUMNS / 2; ++c)
+                    row[c] = row[2 * c] + row[2 * c + 1];
+                std::fill(row + COLUMNS / 2, row + COLUMNS, 0);
+            }
+            ++shift;
+        }
+        ++heat[(addr >> Memory::PAGE_BITS & (Memory::PAGE_NUM - 1)) * COLUMNS + (now >> shift)];
+    }
+public:
+    Heatmap(): lines(LINE_NUM, LineStat{{0, 0, 0}, 0, 0}), heat(Memory::PAGE_NUM * COLUMNS),
+        shift(0) {}
+    void account(Inst * wb, unsigned long long now) {
+        if (!wb->code)
+            return;
+        hit(wb->inst_pc, FETCH, now);
+        unsigned op = wb->opcode();
+        if (op == 0x3)
+            hit(wb->mem_addr(), READ, now);
+        else if (op == 0x23)
+            hit(wb->mem_addr(), WRITE, now);
+    }
+    void line_csv(std::ostream & os) {
+        os << "line,read,write,fetch,first,last\n";
+        for (unsigned i = 0; i < LINE_NUM; ++i) {
+            const LineStat & l = lines[i];
+            if (l.count[READ] | l.count[WRITE] | l.count[FETCH])
+                os << std::hex << (i << LINE_BITS) << std::dec << "," << l.count[READ] << ","
+                   << l.count[WRITE] << "," << l.count[FETCH] << "," << l.first << "," << l.last
+                   << "\n";
+        }
+    }
+    void page_csv(std::ostream & os) {
+        const unsigned per_page = 1 << (Memory::PAGE_BITS - LINE_BITS);
+        os << "page,read,write,fetch,lines,first,last\n";
+        for (unsigned p = 0; p < Memory::PAGE_NUM; ++p) {
+            unsigned long long count[KIND_NUM] = {0, 0, 0}, first = ~0ULL, last = 0;
+            unsigned used = 0;
+            for (unsigned i = p * per_page; i < (p + 1) * per_page; ++i) {
+                const LineStat & l = lines[i];
+                if (!(l.count[READ] | l.count[WRITE] | l.count[FETCH]))
+                    continue;
+                for (int k = 0; k < KIND_NUM; ++k)
+                    count[k] += l.count[k];
+                first = std::min(first, l.first);
+                last = std::max(last, l.last);
+                ++used;
+            }
+            if (used)
+                os << std::hex << (p << Memory::PAGE_BITS) << std::dec << "," << count[READ] << ","
+                   << count[WRITE] << "," << count[FETCH] << "," << used << "," << first << ","
+                   << last << "\n";
+        }
+    }
+    void heat_csv(std::ostream & os) {
+        os << "page";
+        for (unsigned c = 0; c < COLUMNS; ++c)
+            os << "," << ((unsigned long long) c << shift);
+        os << "\n";
+        for (unsigned p = 0; p < Memory::PAGE_NUM; ++p) {
+            const unsigned * row = &heat[p * COLUMNS];
+            if (std::count(row, row + COLUMNS, 0U) == COLUMNS)
+                continue;
+            os << std::hex << (p << Memory::PAGE_BITS) << std::dec;
+            for (unsigned c = 0; c < COLUMNS; ++c)
+                os << "," << row[c];
+            os << "\n";
+        }
+    }
+    void report(std::ostream & os) {
+        const unsigned per_page = 1 << (Memory::PAGE_BITS - LINE_BITS);
+        unsigned pages = 0, used = 0;
+        unsigned long long data = 0, sparse = 0;
+        for (unsigned p = 0; p < Memory::PAGE_NUM; ++p) {
+            unsigned n = 0;
+            unsigned long long acc = 0;
+            for (unsigned i = p * per_page; i < (p + 1) * per_page; ++i) {
+                const LineStat & l = lines[i];
+                if (l.count[READ] | l.count[WRITE] | l.count[FETCH])
+                    ++n;
+                acc += l.count[READ] + l.count[WRITE];
+            }
+            if (!n)
+                continue;
+            ++pages;
+            used += n;
+            data += acc;
+            if (n * 4 <= per_page)
+                sparse += acc;
+        }
+        os << "pages touched: " << pages << std::endl;
+        os << "lines touched: " << used << std::endl;
+        if (pages)
+            os << "line utilization: " << std::fixed << std::setprecision(2)
+               << used * 100.0 / (pages * per_page) << "%" << std::defaultfloat << std::endl;
+        if (data)
+            os << "data accesses on sparse pages: " << std::fixed << std::setprecision(2)
+               << sparse * 100.0 / data << "%" << std::defaultfloat << std::endl;
+    }
+};
+
+#endif
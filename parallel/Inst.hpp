@@ -4,25 +4,45 @@
 #include "Register.hpp"
 #include "Memory.hpp"
 #include "Predictor.hpp"
+#include "Serialize.hpp"
+#include "Stats.hpp"
+#include "../common/Decode.hpp"
+#include <iostream>
+#include <cstdlib>
 #include <unordered_map>
 
-Memory mem;
-Register reg[32];
-Register pc;
-bool stall, bubble, ret;
-std::unordered_map<unsigned, Predictor> pred;
-unsigned branch, correct;
+thread_local Memory mem;
+thread_local Register reg[32];
+thread_local Register pc;
+thread_local bool stall, bubble, ret;
+thread_local std::unordered_map<unsigned, Predictor> pred;
+thread_local unsigned branch, correct;
+thread_local unsigned long long cycle, instret;
 
 enum Stage {IF, ID, EX, MEM, WB};
 
-unsigned sgnext(unsigned imm, int hi) {
-    if (imm & (1 << hi))
-        imm |= 0xFFFFFFFF >> hi << hi;
-    return imm;
-}
+enum Cause {RETIRE, LOAD_USE, BRANCH_FLUSH, JALR_FLUSH, MEM_STALL, FILL, CAUSE_NUM};
 
 class Inst {
 public:
+    unsigned code, inst_pc;
+    Cause cause;
+    Inst(): code(0), inst_pc(0), cause(RETIRE) {}
+    unsigned opcode() const {
+        return code & 0x7F;
+    }
+    unsigned rd() const {
+        unsigned op = opcode();
+        return op == 0x23 || op == 0x63 ? 0 : code >> 7 & 0x1F;
+    }
+    unsigned rs1() const {
+        unsigned op = opcode();
+        return op == 0x37 || op == 0x17 || op == 0x6F ? 0 : code >> 15 & 0x1F;
+    }
+    unsigned rs2() const {
+        unsigned op = opcode();
+        return op == 0x33 || op == 0x23 || op == 0x63 ? code >> 20 & 0x1F : 0;
+    }
     virtual void pc_modify() {
         unsigned cur_pc = pc.read();
         pc.write(cur_pc + 4);
@@ -34,19 +54,39 @@ public:
     virtual bool forward(Stage stage, unsigned src, unsigned & rval) {
         return false;
     }
+    virtual unsigned mem_addr() {
+        return 0;
+    }
+    virtual unsigned mem_data() {
+        return 0;
+    }
+    virtual bool outcome(bool & taken, bool & miss) {
+        return false;
+    }
+    virtual void save(std::ostream & os) {}
+    virtual void load(std::istream & is) {}
     virtual ~Inst() {}
     static Inst * parse(unsigned code);
 };
 
-Inst * inst[5];
+thread_local Inst * inst[5];
+thread_local Inst * inst2[5];
+thread_local bool dual;
 
 class SrcInst: public Inst {
 public:
     void get_fwd(unsigned src, unsigned & rval) {
         if (!src) return;
-        if (inst[EX]->forward(EX, src, rval)) return;
-        if (inst[MEM]->forward(MEM, src, rval)) return;
-        inst[WB]->forward(WB, src, rval);
+        if (dual && inst2[EX]->forward(EX, src, rval)) {
+            COUNT_IF(inst2[EX]->opcode() != 0x3, FWD_EXMEM);
+            return;
+        }
+        if (inst[EX]->forward(EX, src, rval)) {
+            COUNT_IF(inst[EX]->opcode() != 0x3, FWD_EXMEM);
+            return;
+        }
+        if ((dual && inst2[WB]->forward(WB, src, rval)) || inst[WB]->forward(WB, src, rval))
+            COUNT(FWD_MEMWB);
     }
 };
 
@@ -71,16 +111,26 @@ public:
         }
         return false;
     }
-    void set(unsigned src1, unsigned src2, unsigned dest) {
-        this->src1 = src1;
-        this->src2 = src2;
-        this->dest = dest;
+    void save(std::ostream & os) {
+        put(os, lhs);
+        put(os, rhs);
+        put(os, ans);
+    }
+    void load(std::istream & is) {
+        get(is, lhs);
+        get(is, rhs);
+        get(is, ans);
+    }
+    void set(const Fields & f) {
+        src1 = f.rs1;
+        src2 = f.rs2;
+        dest = f.rd;
     }
-    static Inst * parse(unsigned code);
 };
 
 class ADD: public RTypeInst {
 public:
+    static const Op op = OP_ADD;
     void execute() {
         ans = lhs + rhs;
     }
@@ -88,6 +138,7 @@ public:
 
 class SUB: public RTypeInst {
 public:
+    static const Op op = OP_SUB;
     void execute() {
         ans = lhs - rhs;
     }
@@ -95,6 +146,7 @@ public:
 
 class SLL: public RTypeInst {
 public:
+    static const Op op = OP_SLL;
     void execute() {
         ans = lhs << (rhs & 0x1F);
     }
@@ -102,6 +154,7 @@ public:
 
 class SLT: public RTypeInst {
 public:
+    static const Op op = OP_SLT;
     void execute() {
         ans = (int) lhs < (int) rhs;
     }
@@ -109,6 +162,7 @@ public:
 
 class SLTU: public RTypeInst {
 public:
+    static const Op op = OP_SLTU;
     void execute() {
         ans = lhs < rhs;
     }
@@ -116,6 +170,7 @@ public:
 
 class XOR: public RTypeInst {
 public:
+    static const Op op = OP_XOR;
     void execute() {
         ans = lhs ^ rhs;
     }
@@ -123,6 +178,7 @@ public:
 
 class SRL: public RTypeInst {
 public:
+    static const Op op = OP_SRL;
     void execute() {
         ans = lhs >> (rhs & 0x1F);
     }
@@ -130,6 +186,7 @@ public:
 
 class SRA: public RTypeInst {
 public:
+    static const Op op = OP_SRA;
     void execute() {
         ans = (int) lhs >> (rhs & 0x1F);
     }
@@ -137,6 +194,7 @@ public:
 
 class OR: public RTypeInst {
 public:
+    static const Op op = OP_OR;
     void execute() {
         ans = lhs | rhs;
     }
@@ -144,6 +202,7 @@ public:
 
 class AND: public RTypeInst {
 public:
+    static const Op op = OP_AND;
     void execute() {
         ans = lhs & rhs;
     }
@@ -168,35 +227,61 @@ public:
         }
         return false;
     }
-    void set(unsigned imm, unsigned src, unsigned dest) {
-        this->imm = imm;
-        this->src = src;
-        this->dest = dest;
+    void save(std::ostream & os) {
+        put(os, rval);
+        put(os, ans);
+    }
+    void load(std::istream & is) {
+        get(is, rval);
+        get(is, ans);
+    }
+    void set(const Fields & f) {
+        imm = f.imm;
+        src = f.rs1;
+        dest = f.rd;
     }
-    static Inst * parse(unsigned code);
 };
 
 class JALR: public ITypeInst {
 protected:
-    unsigned cur_pc, pred_pc;
+    unsigned cur_pc, pred_pc, next_pc;
 public:
+    static const Op op = OP_JALR;
     void pc_modify() {
         cur_pc = pc.read();
         pred_pc = cur_pc + 4;
         pc.write(pred_pc);
     }
     void execute() {
-        unsigned next_pc = (rval + imm) >> 1 << 1;
+        next_pc = (rval + imm) >> 1 << 1;
         if (pred_pc != next_pc) {
             pc.write(next_pc);
             bubble = true;
         }
         ans = cur_pc + 4;
     }
+    bool outcome(bool & taken, bool & miss) {
+        taken = true;
+        miss = pred_pc != next_pc;
+        return true;
+    }
+    void save(std::ostream & os) {
+        ITypeInst::save(os);
+        put(os, cur_pc);
+        put(os, pred_pc);
+        put(os, next_pc);
+    }
+    void load(std::istream & is) {
+        ITypeInst::load(is);
+        get(is, cur_pc);
+        get(is, pred_pc);
+        get(is, next_pc);
+    }
 };
 
 class ADDI: public ITypeInst {
 public:
+    static const Op op = OP_ADDI;
     void execute() {
         ans = rval + imm;
     }
@@ -204,13 +289,17 @@ public:
 
 class NOP: public ADDI {
 public:
-    NOP() {
-        set(0, 0, 0);
+    NOP(Cause cause = FILL, unsigned inst_pc = 0) {
+        set(Fields());
+        rval = ans = 0;
+        this->cause = cause;
+        this->inst_pc = inst_pc;
     }
 };
 
 class SLTI: public ITypeInst {
 public:
+    static const Op op = OP_SLTI;
     void execute() {
         ans = (int) rval < (int) imm;
     }
@@ -218,6 +307,7 @@ public:
 
 class SLTIU: public ITypeInst {
 public:
+    static const Op op = OP_SLTIU;
     void execute() {
         ans = rval < imm;
     }
@@ -225,6 +315,7 @@ public:
 
 class XORI: public ITypeInst {
 public:
+    static const Op op = OP_XORI;
     void execute() {
         ans = rval ^ imm;
     }
@@ -232,6 +323,7 @@ public:
 
 class ORI: public ITypeInst {
 public:
+    static const Op op = OP_ORI;
     void execute() {
         ans = rval | imm;
     }
@@ -239,6 +331,7 @@ public:
 
 class ANDI: public ITypeInst {
 public:
+    static const Op op = OP_ANDI;
     void execute() {
         ans = rval & imm;
     }
@@ -246,6 +339,7 @@ public:
 
 class SLLI: public ITypeInst {
 public:
+    static const Op op = OP_SLLI;
     void execute() {
         ans = rval << (imm & 0x1F);
     }
@@ -253,6 +347,7 @@ public:
 
 class SRLI: public ITypeInst {
 public:
+    static const Op op = OP_SRLI;
     void execute() {
         ans = rval >> (imm & 0x1F);
     }
@@ -260,6 +355,7 @@ public:
 
 class SRAI: public ITypeInst {
 public:
+    static const Op op = OP_SRAI;
     void execute() {
         ans = (int) rval >> (imm & 0x1F);
     }
@@ -272,6 +368,12 @@ public:
     void execute() {
         addr = rval + imm;
     }
+    unsigned mem_addr() {
+        return addr;
+    }
+    unsigned mem_data() {
+        return ans;
+    }
     bool forward(Stage stage, unsigned src, unsigned & rval) {
         if (src == dest) {
             if (stage == EX)
@@ -282,10 +384,19 @@ public:
         }
         return false;
     }
+    void save(std::ostream & os) {
+        ITypeInst::save(os);
+        put(os, addr);
+    }
+    void load(std::istream & is) {
+        ITypeInst::load(is);
+        get(is, addr);
+    }
  };
 
 class LB: public LoadInst {
 public:
+    static const Op op = OP_LB;
     void mem_access() {
         ans = sgnext(mem.read(addr), 7);
     }
@@ -293,6 +404,7 @@ public:
 
 class LH: public LoadInst {
 public:
+    static const Op op = OP_LH;
     void mem_access() {
         ans = sgnext(mem.read_word(addr), 15);
     }
@@ -300,6 +412,7 @@ public:
 
 class LW: public LoadInst {
 public:
+    static const Op op = OP_LW;
     void mem_access() {
         ans = mem.read_dword(addr);
     }
@@ -307,6 +420,7 @@ public:
 
 class LBU: public LoadInst {
 public:
+    static const Op op = OP_LBU;
     void mem_access() {
         ans = mem.read(addr);
     }
@@ -314,6 +428,7 @@ public:
 
 class LHU: public LoadInst {
 public:
+    static const Op op = OP_LHU;
     void mem_access() {
         ans = mem.read_word(addr);
     }
@@ -333,16 +448,32 @@ public:
     void execute() {
         addr = base + imm;
     }
-    void set(unsigned imm, unsigned src1, unsigned src2) {
-        this->imm = imm;
-        this->src1 = src1;
-        this->src2 = src2;
+    unsigned mem_addr() {
+        return addr;
+    }
+    unsigned mem_data() {
+        return data;
+    }
+    void save(std::ostream & os) {
+        put(os, base);
+        put(os, data);
+        put(os, addr);
+    }
+    void load(std::istream & is) {
+        get(is, base);
+        get(is, data);
+        get(is, addr);
+    }
+    void set(const Fields & f) {
+        imm = f.imm;
+        src1 = f.rs1;
+        src2 = f.rs2;
     }
-    static Inst * parse(unsigned code);
 };
 
 class SB: public STypeInst {
 public:
+    static const Op op = OP_SB;
     void mem_access() {
         mem.write(addr, data);
         ret = addr == 0x30004;
@@ -351,6 +482,7 @@ public:
 
 class SH: public STypeInst {
 public:
+    static const Op op = OP_SH;
     void mem_access() {
         mem.write_word(addr, data);
         ret = addr == 0x30004;
@@ -359,6 +491,7 @@ public:
 
 class SW: public STypeInst {
 public:
+    static const Op op = OP_SW;
     void mem_access() {
         mem.write_dword(addr, data);
         ret = addr == 0x30004;
@@ -368,11 +501,13 @@ public:
 class BTypeInst: public SrcInst {
 protected:
     unsigned imm, src1, src2;
-    unsigned lhs, rhs, cur_pc, pred_pc;
+    unsigned lhs, rhs, cur_pc, pred_pc, next_pc;
+    Predictor * entry;
 public:
     void pc_modify() {
         cur_pc = pc.read();
-        bool taken = pred[cur_pc].predict();
+        entry = &pred[cur_pc];
+        bool taken = entry->predict();
         pred_pc = cur_pc + (taken ? imm : 4);
         pc.write(pred_pc);
     }
@@ -384,7 +519,6 @@ public:
     }
     void execute() {
         ++branch;
-        unsigned next_pc;
         bool taken = judge(lhs, rhs);
         next_pc = cur_pc + (taken ? imm : 4);
         if (pred_pc != next_pc) {
@@ -392,21 +526,41 @@ public:
             bubble = true;
         } else
             ++correct;
-        pred[cur_pc].update(taken);
+        entry->update(taken);
+    }
+    bool outcome(bool & taken, bool & miss) {
+        taken = next_pc != cur_pc + 4;
+        miss = pred_pc != next_pc;
+        return true;
+    }
+    void save(std::ostream & os) {
+        put(os, lhs);
+        put(os, rhs);
+        put(os, cur_pc);
+        put(os, pred_pc);
+        put(os, next_pc);
+    }
+    void load(std::istream & is) {
+        get(is, lhs);
+        get(is, rhs);
+        get(is, cur_pc);
+        get(is, pred_pc);
+        get(is, next_pc);
+        entry = &pred[cur_pc];
     }
     virtual bool judge(unsigned lhs, unsigned rhs) {
         return true;
     }
-    void set(unsigned imm, unsigned src1, unsigned src2) {
-        this->imm = imm;
-        this->src1 = src1;
-        this->src2 = src2;
+    void set(const Fields & f) {
+        imm = f.imm;
+        src1 = f.rs1;
+        src2 = f.rs2;
     }
-    static Inst * parse(unsigned code);
 };
 
 class BEQ: public BTypeInst {
 public:
+    static const Op op = OP_BEQ;
     bool judge(unsigned lhs, unsigned rhs) {
         return lhs == rhs;
     }
@@ -414,6 +568,7 @@ public:
 
 class BNE: public BTypeInst {
 public:
+    static const Op op = OP_BNE;
     bool judge(unsigned lhs, unsigned rhs) {
         return lhs != rhs;
     }
@@ -421,6 +576,7 @@ public:
 
 class BLT: public BTypeInst {
 public:
+    static const Op op = OP_BLT;
     bool judge(unsigned lhs, unsigned rhs) {
         return (int) lhs < (int) rhs;
     }
@@ -428,6 +584,7 @@ public:
 
 class BGE: public BTypeInst {
 public:
+    static const Op op = OP_BGE;
     bool judge(unsigned lhs, unsigned rhs) {
         return (int) lhs >= (int) rhs;
     }
@@ -435,6 +592,7 @@ public:
 
 class BLTU: public BTypeInst {
 public:
+    static const Op op = OP_BLTU;
     bool judge(unsigned lhs, unsigned rhs) {
         return lhs < rhs;
     }
@@ -442,6 +600,7 @@ public:
 
 class BGEU: public BTypeInst {
 public:
+    static const Op op = OP_BGEU;
     bool judge(unsigned lhs, unsigned rhs) {
         return lhs >= rhs;
     }
@@ -451,15 +610,15 @@ class UTypeInst: public Inst {
 protected:
     unsigned imm, dest;
 public:
-    void set(unsigned imm, unsigned dest) {
-        this->imm = imm;
-        this->dest = dest;
+    void set(const Fields & f) {
+        imm = f.imm;
+        dest = f.rd;
     }
-    static Inst * parse(unsigned code);
 };
 
 class LUI: public UTypeInst {
 public:
+    static const Op op = OP_LUI;
     void write_back() {
         reg[dest].write(imm);
     }
@@ -476,6 +635,7 @@ class AUIPC: public UTypeInst {
 protected:
     unsigned cur_pc, ans;
 public:
+    static const Op op = OP_AUIPC;
     void pc_modify() {
         cur_pc = pc.read();
         pc.write(cur_pc + 4);
@@ -493,23 +653,31 @@ public:
         }
         return false;
     }
+    void save(std::ostream & os) {
+        put(os, cur_pc);
+        put(os, ans);
+    }
+    void load(std::istream & is) {
+        get(is, cur_pc);
+        get(is, ans);
+    }
 };
 
 class JTypeInst: public Inst {
 protected:
     unsigned imm, dest;
 public:
-    void set(unsigned imm, unsigned dest) {
-        this->imm = imm;
-        this->dest = dest;
+    void set(const Fields & f) {
+        imm = f.imm;
+        dest = f.rd;
     }
-    static Inst * parse(unsigned code);
 };
 
 class JAL: public JTypeInst {
 protected:
     unsigned cur_pc, ans;
 public:
+    static const Op op = OP_JAL;
     void pc_modify() {
         cur_pc = pc.read();
         pc.write(cur_pc + imm);
@@ -527,159 +695,37 @@ public:
         }
         return false;
     }
+    void save(std::ostream & os) {
+        put(os, cur_pc);
+        put(os, ans);
+    }
+    void load(std::istream & is) {
+        get(is, cur_pc);
+        get(is, ans);
+    }
 };
 
-Inst * Inst::parse(unsigned code) {
-    unsigned opcode = code & 0x7F;
-    if (opcode == 0x33)
-        return RTypeInst::parse(code);
-    else if (opcode == 0x67 || opcode == 0x3 || opcode == 0x13)
-        return ITypeInst::parse(code);
-    else if (opcode == 0x23)
-        return STypeInst::parse(code);
-    else if (opcode == 0x63)
-        return BTypeInst::parse(code);
-    else if (opcode == 0x37 || opcode == 0x17)
-        return UTypeInst::parse(code);
-    else if (opcode = 0x6F)
-        return JTypeInst::parse(code);
-}
-
-Inst * RTypeInst::parse(unsigned code) {
-    RTypeInst * ret;
-    unsigned funct3 = code >> 12 & 0x7;
-    unsigned funct7 = code >> 25;
-    if (funct3 == 0 && funct7 == 0)
-        ret = new ADD;
-    else if (funct3 == 0 && funct7 == 0x20)
-        ret = new SUB;
-    else if (funct3 == 0x1)
-        ret = new SLL;
-    else if (funct3 == 0x2)
-        ret = new SLT;
-    else if (funct3 == 0x3)
-        ret = new SLTU;
-    else if (funct3 == 0x4)
-        ret = new XOR;
-    else if (funct3 == 0x5 && funct7 == 0)
-        ret = new SRL;
-    else if (funct3 == 0x5 && funct7 == 0x20)
-        ret = new SRA;
-    else if (funct3 == 0x6)
-        ret = new OR;
-    else if (funct3 == 0x7)
-        ret = new AND;
-    unsigned src1 = code >> 15 & 0x1F;
-    unsigned src2 = code >> 20 & 0x1F;
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(src1, src2, dest);
-    return (Inst *) ret;
-}
-
-Inst * ITypeInst::parse(unsigned code) {
-    ITypeInst * ret;
-    unsigned opcode = code & 0x7F;
-    unsigned funct3 = code >> 12 & 0x7;
-    unsigned funct7 = code >> 25;
-    if (opcode == 0x67)
-        ret = new JALR;
-    else if (opcode == 0x3) {
-        if (funct3 == 0)
-            ret = new LB;
-        else if (funct3 == 0x1)
-            ret = new LH;
-        else if (funct3 == 0x2)
-            ret = new LW;
-        else if (funct3 == 0x4)
-            ret = new LBU;
-        else if (funct3 == 0x5)
-            ret = new LHU;
-    } else if (opcode == 0x13) {
-        if (funct3 == 0)
-            ret = new ADDI;
-        else if (funct3 == 0x2)
-            ret = new SLTI;
-        else if (funct3 == 0x3)
-            ret = new SLTIU;
-        else if (funct3 == 0x4)
-            ret = new XORI;
-        else if (funct3 == 0x6)
-            ret = new ORI;
-        else if (funct3 == 0x7)
-            ret = new ANDI;
-        else if (funct3 == 0x1)
-            ret = new SLLI;
-        else if (funct3 == 0x5 && funct7 == 0)
-            ret = new SRLI;
-        else if (funct3 == 0x5 && funct7 == 0x20)
-            ret = new SRAI;
-    }
-    unsigned imm = sgnext(code >> 20, 11);
-    unsigned src = code >> 15 & 0x1F;
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(imm, src, dest);
-    return (Inst *) ret;
-}
-
-Inst * STypeInst::parse(unsigned code) {
-    STypeInst * ret;
-    unsigned funct3 = code >> 12 & 0x7;
-    if (funct3 == 0)
-        ret = new SB;
-    else if (funct3 == 0x1)
-        ret = new SH;
-    else if (funct3 == 0x2)
-        ret = new SW;
-    unsigned imm = sgnext((code >> 7 & 0x1F) + ((code >> 25 & 0x7F) << 5), 11);
-    unsigned src1 = code >> 15 & 0x1F;
-    unsigned src2 = code >> 20 & 0x1F;
-    ret->set(imm, src1, src2);
-    return (Inst *) ret;
-}
+class Illegal: public Inst {
+public:
+    static const Op op = OP_ILLEGAL;
+    void set(const Fields &) {}
+    void write_back() {
+        std::cerr << "illegal instruction " << std::hex << code << " at " << inst_pc << std::dec
+                  << std::endl;
+        std::exit(1);
+    }
+};
 
-Inst * BTypeInst::parse(unsigned code) {
-    BTypeInst * ret;
-    unsigned funct3 = code >> 12 & 0x7;
-    if (funct3 == 0)
-        ret = new BEQ;
-    else if (funct3 == 0x1)
-        ret = new BNE;
-    else if (funct3 == 0x4)
-        ret = new BLT;
-    else if (funct3 == 0x5)
-        ret = new BGE;
-    else if (funct3 == 0x6)
-        ret = new BLTU;
-    else if (funct3 == 0x7)
-        ret = new BGEU;
-    unsigned imm = sgnext(((code >> 8 & 0xF) << 1) + ((code >> 25 & 0x3F) << 5) +
-        ((code >> 7 & 0x1) << 11) + ((code >> 31 & 1) << 12), 12);
-    unsigned src1 = code >> 15 & 0x1F;
-    unsigned src2 = code >> 20 & 0x1F;
-    ret->set(imm, src1, src2);
-    return (Inst *) ret;
-}
+constexpr HandlerTable<Inst, Illegal, LUI, AUIPC, JAL, JALR, BEQ, BNE, BLT, BGE, BLTU, BGEU, LB, LH,
+                       LW, LBU, LHU, SB, SH, SW, ADDI, SLTI, SLTIU, XORI, ORI, ANDI, SLLI, SRLI,
+                       SRAI, ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND> handler;
 
-Inst * UTypeInst::parse(unsigned code) {
-    UTypeInst * ret;
-    unsigned opcode = code & 0x7F;
-    if (opcode == 0x37)
-        ret = new LUI;
-    else if (opcode == 0x17)
-        ret = new AUIPC;
-    unsigned imm = code & 0xFFFFF000;
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(imm, dest);
-    return (Inst *) ret;
-}
+static_assert(handler.complete(), "handler table misses an Op");
 
-Inst * JTypeInst::parse(unsigned code) {
-    JTypeInst * ret = new JAL;
-    unsigned imm = sgnext(((code >> 21 & 0x3FF) << 1) + ((code >> 20 & 0x1) << 11) +
-        ((code >> 12 & 0xFF) << 12) + ((code >> 31 & 0x1) << 20), 20);
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(imm, dest);
-    return (Inst *) ret;
+Inst * Inst::parse(unsigned code) {
+    Inst * ret = handler(code);
+    ret->code = code;
+    return ret;
 }
 
-#endif
\ No newline at end of file
+#endif
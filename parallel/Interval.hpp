@@ -0,0 +1,88 @@
+#ifndef INTERVAL_HPP
+#define INTERVAL_HPP 1
+
+#include "Inst.hpp"
+#include "Pipeline.hpp"
+#include "Functional.hpp"
+#include "Checkpoint.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+class IntervalSim {
+private:
+    struct Result {
+        unsigned long long cycle, instret;
+        unsigned branch, correct;
+    };
+    unsigned long long len;
+    unsigned workers;
+    std::vector<std::string> ckpt;
+    std::vector<Result> res;
+    std::atomic<unsigned> next;
+    void work() {
+        reg[0].set_zero();
+        for (int i = ID; i <= WB; ++i)
+            inst[i] = new NOP;
+        unsigned loaded = 0;
+        unsigned k;
+        while ((k = next++) < ckpt.size()) {
+            for (; loaded <= k; ++loaded) {
+                std::istringstream is(ckpt[loaded]);
+                load_state(is);
+            }
+            ret = false;
+            cycle = 0;
+            branch = correct = 0;
+            unsigned long long start = instret;
+            while (!ret && instret - start < len) {
+                if (instret - start + in_flight() < len)
+                    tick();
+                else
+                    drain();
+            }
+            res[k] = {cycle, instret - start, branch, correct};
+        }
+        for (int i = ID; i <= WB; ++i)
+            delete inst[i];
+    }
+public:
+    IntervalSim(unsigned long long len, unsigned workers): len(len), workers(workers) {}
+    void run() {
+        while (!ret) {
+            std::ostringstream os;
+            save_state(os);
+            ckpt.push_back(os.str());
+            fast_forward(len);
+        }
+        res.resize(ckpt.size());
+        next = 0;
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < workers; ++i)
+            pool.emplace_back(&IntervalSim::work, this);
+        for (auto & t: pool)
+            t.join();
+    }
+    void report(std::ostream & os) {
+        Result sum = {0, 0, 0, 0};
+        for (auto & r: res) {
+            sum.cycle += r.cycle;
+            sum.instret += r.instret;
+            sum.branch += r.branch;
+            sum.correct += r.correct;
+        }
+        os << "intervals: " << res.size() << std::endl;
+        os << "cycles: " << sum.cycle << std::endl;
+        os << "instructions: " << sum.instret << std::endl;
+        if (sum.instret)
+            os << "CPI: " << (double) sum.cycle / sum.instret << std::endl;
+        if (sum.branch)
+            os << "branch: " << (double) sum.correct / sum.branch * 100 << "%" << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef LOCKSTEP_HPP
+#define LOCKSTEP_HPP 1
+
+#include "Inst.hpp"
+#include "../common/Decode.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+struct LockstepStats {
+    unsigned long long steps = 0, insts = 0, slots = 0;
+};
+
+template <unsigned W>
+class Lockstep {
+private:
+    static const unsigned DEAD = ~0U;
+    alignas(64) unsigned x[32][W];
+    alignas(64) unsigned pc[W];
+    alignas(64) unsigned mask[W];
+    std::vector<Memory> & lane_mem;
+    std::vector<bool> written;
+    unsigned live;
+    int result[W];
+
+    unsigned min_pc() {
+        unsigned p = DEAD;
+        for (unsigned l = 0; l < W; ++l)
+            p = pc[l] < p ? pc[l] : p;
+        return p;
+    }
+    void select(unsigned p) {
+        for (unsigned l = 0; l < W; ++l)
+            mask[l] = pc[l] == p ? DEAD : 0;
+    }
+    void finish(unsigned l, int value) {
+        result[l] = value;
+        pc[l] = DEAD;
+        mask[l] = 0;
+        --live;
+    }
+    template <class F>
+    void alu(unsigned rd, F f) {
+        if (!rd)
+            return;
+        for (unsigned l = 0; l < W; ++l) {
+            unsigned r = f(l);
+            x[rd][l] = (r & mask[l]) | (x[rd][l] & ~mask[l]);
+        }
+    }
+    template <class F>
+    void jump(F f) {
+        for (unsigned l = 0; l < W; ++l) {
+            unsigned t = f(l);
+            pc[l] = (t & mask[l]) | (pc[l] & ~mask[l]);
+        }
+    }
+    template <class F>
+    void branch(unsigned p, unsigned imm, F taken) {
+        jump([&](unsigned l) { return taken(l) ? p + imm : p + 4; });
+    }
+    template <class F>
+    void load(unsigned rd, unsigned rs1, unsigned imm, F f) {
+        for (unsigned l = 0; l < W; ++l)
+            if (mask[l]) {
+                unsigned v = f(lane_mem[l], x[rs1][l] + imm);
+                if (rd)
+                    x[rd][l] = v;
+            }
+    }
+    template <class F>
+    void store(unsigned rs1, unsigned rs2, unsigned imm, F f) {
+        for (unsigned l = 0; l < W; ++l)
+            if (mask[l]) {
+                unsigned addr = x[rs1][l] + imm;
+                f(lane_mem[l], addr, x[rs2][l]);
+                mark(addr);
+                if (addr == 0x30004)
+                    finish(l, x[10][l] & 0xFF);
+            }
+    }
+    unsigned fetch(unsigned p) {
+        unsigned lead = 0;
+        while (!mask[lead])
+            ++lead;
+        unsigned code = lane_mem[lead].read_dword(p);
+        if (written[p >> Memory::PAGE_BITS & (Memory::PAGE_NUM - 1)] ||
+            written[(p + 3) >> Memory::PAGE_BITS & (Memory::PAGE_NUM - 1)])
+            for (unsigned l = lead + 1; l < W; ++l)
+                if (mask[l] && (unsigned) lane_mem[l].read_dword(p) != code)
+                    mask[l] = 0;
+        return code;
+    }
+    void execute(unsigned p, unsigned code) {
+        Op op = decode(code);
+        Fields f = fields(code, isa[op].format);
+        unsigned rd = f.rd, imm = f.imm;
+        unsigned * a = x[f.rs1], * b = x[f.rs2];
+        switch (op) {
+            case OP_LUI: alu(rd, [&](unsigned l) { return imm; }); break;
+            case OP_AUIPC: alu(rd, [&](unsigned l) { return p + imm; }); break;
+            case OP_JAL:
+                alu(rd, [&](unsigned l) { return p + 4; });
+                jump([&](unsigned l) { return p + imm; });
+                return;
+            case OP_JALR: {
+                alignas(64) unsigned t[W];
+                for (unsigned l = 0; l < W; ++l)
+                    t[l] = (a[l] + imm) >> 1 << 1;
+                alu(rd, [&](unsigned l) { return p + 4; });
+                jump([&](unsigned l) { return t[l]; });
+                return;
+            }
+            case OP_BEQ: branch(p, imm, [&](unsigned l) { return a[l] == b[l]; }); return;
+            case OP_BNE: branch(p, imm, [&](unsigned l) { return a[l] != b[l]; }); return;
+            case OP_BLT:
+                branch(p, imm, [&](unsigned l) { return (int) a[l] < (int) b[l]; });
+                return;
+            case OP_BGE:
+                branch(p, imm, [&](unsigned l) { return (int) a[l] >= (int) b[l]; });
+                return;
+            case OP_BLTU: branch(p, imm, [&](unsigned l) { return a[l] < b[l]; }); return;
+            case OP_BGEU: branch(p, imm, [&](unsigned l) { return a[l] >= b[l]; }); return;
+            case OP_LB:
+                load(rd, f.rs1, imm, [](Memory & m, unsigned addr) {
+                    return sgnext(m.read(addr), 7);
+                });
+                break;
+            case OP_LH:
+                load(rd, f.rs1, imm, [](Memory & m, unsigned addr) {
+                    return sgnext(m.read_word(addr), 15);
+                });
+                break;
+            case OP_LW:
+                load(rd, f.rs1, imm, [](Memory & m, unsigned addr) {
+                    return (unsigned) m.read_dword(addr);
+                });
+                break;
+            case OP_LBU:
+                load(rd, f.rs1, imm, [](Memory & m, unsigned addr) { return m.read(addr); });
+                break;
+            case OP_LHU:
+                load(rd, f.rs1, imm, [](Memory & m, unsigned addr) { return m.read_word(addr); });
+                break;
+            case OP_SB:
+                store(f.rs1, f.rs2, imm, [](Memory & m, unsigned addr, unsigned v) {
+                    m.write(addr, v);
+                });
+                break;
+            case OP_SH:
+                store(f.rs1, f.rs2, imm, [](Memory & m, unsigned addr, unsigned v) {
+                    m.write_word(addr, v);
+                });
+                break;
+            case OP_SW:
+                store(f.rs1, f.rs2, imm, [](Memory & m, unsigned addr, unsigned v) {
+                    m.write_dword(addr, v);
+                });
+                break;
+            case OP_ADDI: alu(rd, [&](unsigned l) { return a[l] + imm; }); break;
+            case OP_SLTI:
+                alu(rd, [&](unsigned l) { return (unsigned) ((int) a[l] < (int) imm); });
+                break;
+            case OP_SLTIU: alu(rd, [&](unsigned l) { return (unsigned) (a[l] < imm); }); break;
+            case OP_XORI: alu(rd, [&](unsigned l) { return a[l] ^ imm; }); break;
+            case OP_ORI: alu(rd, [&](unsigned l) { return a[l] | imm; }); break;
+            case OP_ANDI: alu(rd, [&](unsigned l) { return a[l] & imm; }); break;
+            case OP_SLLI: alu(rd, [&](unsigned l) { return a[l] << (imm & 0x1F); }); break;
+            case OP_SRLI: alu(rd, [&](unsigned l) { return a[l] >> (imm & 0x1F); }); break;
+            case OP_SRAI:
+                alu(rd, [&](unsigned l) { return (unsigned) ((int) a[l] >> (imm & 0x1F)); });
+                break;
+            case OP_ADD: alu(rd, [&](unsigned l) { return a[l] + b[l]; }); break;
+            case OP_SUB: alu(rd, [&](unsigned l) { return a[l] - b[l]; }); break;
+            case OP_SLL: alu(rd, [&](unsigned l) { return a[l] << (b[l] & 0x1F); }); break;
+            case OP_SLT:
+                alu(rd, [&](unsigned l) { return (unsigned) ((int) a[l] < (int) b[l]); });
+                break;
+            case OP_SLTU: alu(rd, [&](unsigned l) { return (unsigned) (a[l] < b[l]); }); break;
+            case OP_XOR: alu(rd, [&](unsigned l) { return a[l] ^ b[l]; }); break;
+            case OP_SRL: alu(rd, [&](unsigned l) { return a[l] >> (b[l] & 0x1F); }); break;
+            case OP_SRA:
+                alu(rd, [&](unsigned l) { return (unsigned) ((int) a[l] >> (b[l] & 0x1F)); });
+                break;
+            case OP_OR: alu(rd, [&](unsigned l) { return a[l] | b[l]; }); break;
+            case OP_AND: alu(rd, [&](unsigned l) { return a[l] & b[l]; }); break;
+            default:
+                for (unsigned l = 0; l < W; ++l)
+                    if (mask[l]) {
+                        std::cerr << "lane " << l << ": illegal instruction " << std::hex << code
+                                  << " at " << p << std::dec << std::endl;
+                        finish(l, -1);
+                    }
+                return;
+        }
+        jump([&](unsigned l) { return p + 4; });
+    }
+public:
+    Lockstep(std::vector<Memory> & lane_mem): lane_mem(lane_mem),
+        written(Memory::PAGE_NUM), live(0) {
+        for (unsigned l = 0; l < W; ++l) {
+            for (int i = 0; i < 32; ++i)
+                x[i][l] = reg[i].read();
+            bool used = l < lane_mem.size();
+            pc[l] = used ? ::pc.read() : DEAD;
+            live += used;
+            result[l] = -1;
+        }
+    }
+    void run(LockstepStats & stats) {
+        while (live) {
+            unsigned p = min_pc();
+            select(p);
+            unsigned code = fetch(p);
+            unsigned n = 0;
+            for (unsigned l = 0; l < W; ++l)
+                n += mask[l] & 1;
+            ++stats.steps;
+            stats.insts += n;
+            stats.slots += lane_mem.size();
+            execute(p, code);
+        }
+    }
+    void mark(unsigned addr) {
+        written[addr >> Memory::PAGE_BITS & (Memory::PAGE_NUM - 1)] = true;
+        written[(addr + 3) >> Memory::PAGE_BITS & (Memory::PAGE_NUM - 1)] = true;
+    }
+    int value(unsigned l) const {
+        return result[l];
+    }
+};
+
+template <unsigned W>
+void run_lanes(unsigned lanes, unsigned addr, bool patch, std::ostream & out,
+               LockstepStats & stats) {
+    for (unsigned base = 0; base < lanes; base += W) {
+        unsigned n = lanes - base < W ? lanes - base : W;
+        std::vector<Memory> lane_mem(n, mem);
+        for (unsigned l = 0; l < n; ++l)
+            if (patch)
+                lane_mem[l].write_dword(addr, lane_mem[l].read_dword(addr) + base + l);
+        Lockstep<W> engine(lane_mem);
+        if (patch)
+            engine.mark(addr);
+        engine.run(stats);
+        for (unsigned l = 0; l < n; ++l) {
+            if (engine.value(l) < 0)
+                out << "illegal" << std::endl;
+            else
+                out << engine.value(l) << std::endl;
+        }
+    }
+}
+
+void run_lockstep(unsigned lanes, unsigned addr, bool patch, std::ostream & out,
+                  std::ostream & log) {
+    LockstepStats stats;
+    if (lanes <= 8)
+        run_lanes<8>(lanes, addr, patch, out, stats);
+    else
+        run_lanes<16>(lanes, addr, patch, out, stats);
+    log << "lanes: " << lanes << std::endl;
+    log << "steps: " << stats.steps << std::endl;
+    log << "instructions: " << stats.insts << std::endl;
+    if (stats.slots)
+        log << "lane utilization: " << std::fixed << std::setprecision(2)
+            << stats.insts * 100.0 / stats.slots << "%" << std::defaultfloat << std::endl;
+}
+
+#endif
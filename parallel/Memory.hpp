@@ -2,24 +2,54 @@
 #define MEMORY_HPP 1
 
 #include <iostream>
+#include <cstring>
+#include "Serialize.hpp"
 
 class Memory {
+public:
+    static const unsigned SIZE = 0x400000;
+    static const unsigned PAGE_BITS = 12;
+    static const unsigned PAGE_SIZE = 1 << PAGE_BITS;
+    static const unsigned PAGE_NUM = SIZE >> PAGE_BITS;
 private:
-    unsigned char storage[0x400000];
+    unsigned char storage[SIZE];
+    bool dirty[PAGE_NUM];
+    void touch(unsigned addr, unsigned len) {
+        dirty[addr >> PAGE_BITS] = true;
+        dirty[(addr + len - 1) >> PAGE_BITS] = true;
+    }
 public:
-    void init() {
+    void init(std::istream & is = std::cin) {
         unsigned addr = 0;
-        while (!std::cin.eof()) {
+        while (!is.eof() && !is.bad()) {
             unsigned byte;
-            while (std::cin >> std::hex >> byte) {
+            while (is >> std::hex >> byte) {
                 storage[addr] = byte;
+                touch(addr, 1);
                 ++addr;
             }
-            std::cin.clear();
-            std::cin.get();
-            std::cin >> addr;
+            is.clear();
+            is.get();
+            is >> addr;
         }
     }
+    void clear() {
+        for (unsigned i = 0; i < PAGE_NUM; ++i)
+            if (dirty[i]) {
+                std::memset(storage + (i << PAGE_BITS), 0, PAGE_SIZE);
+                dirty[i] = false;
+            }
+    }
+    bool page_dirty(unsigned i) const {
+        return dirty[i];
+    }
+    const unsigned char * page(unsigned i) const {
+        return storage + (i << PAGE_BITS);
+    }
+    void write_page(unsigned i, const unsigned char * data) {
+        std::memcpy(storage + (i << PAGE_BITS), data, PAGE_SIZE);
+        dirty[i] = true;
+    }
     int read_dword(unsigned addr) {
         int ret;
         for (int i = 3; i >= 0; --i)
@@ -36,20 +66,44 @@ public:
         return storage[addr];
     }
     void write_dword(unsigned addr, unsigned data) {
+        touch(addr, 4);
         for (int i = 0; i < 4; ++i) {
             storage[addr + i] = data;
             data >>= 8;
         }
     }
     void write_word(unsigned addr, unsigned data) {
+        touch(addr, 2);
         for (int i = 0; i < 2; ++i) {
             storage[addr + i] = data;
             data >>= 8;
         }
     }
     void write(unsigned addr, unsigned data) {
+        touch(addr, 1);
         storage[addr] = data;
     }
+    void save(std::ostream & os) {
+        unsigned cnt = 0;
+        for (unsigned i = 0; i < PAGE_NUM; ++i)
+            cnt += dirty[i];
+        put(os, cnt);
+        for (unsigned i = 0; i < PAGE_NUM; ++i)
+            if (dirty[i]) {
+                put(os, i);
+                os.write((const char *) storage + (i << PAGE_BITS), PAGE_SIZE);
+                dirty[i] = false;
+            }
+    }
+    void load(std::istream & is) {
+        unsigned cnt;
+        get(is, cnt);
+        for (unsigned k = 0; k < cnt; ++k) {
+            unsigned i;
+            get(is, i);
+            is.read((char *) storage + (i << PAGE_BITS), PAGE_SIZE);
+        }
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,229 @@
+#ifndef OOO_HPP
+#define OOO_HPP 1
+
+#include "Inst.hpp"
+#include "Functional.hpp"
+#include <iostream>
+#include <deque>
+#include <vector>
+
+struct OoOConfig {
+    unsigned width = 2;
+    unsigned rob_size = 32;
+    unsigned rs_size = 16;
+    unsigned lsq_size = 8;
+    unsigned mem_ports = 1;
+    unsigned load_latency = 2;
+    unsigned penalty = 2;
+    bool commit_recovery = false;
+};
+
+class OoOCore {
+private:
+    static const unsigned long long NEVER = ~0ULL;
+    enum Kind {ALU, LOAD, STORE, BRANCH};
+    enum Stall {FRONTEND, ROB_FULL, RS_FULL, LSQ_FULL, STALL_NUM};
+    struct Entry {
+        unsigned long long seq, src1, src2;
+        unsigned long long fetched, done;
+        unsigned dest, addr, size;
+        Kind kind;
+        bool mispredict, issued;
+    };
+    OoOConfig cfg;
+    std::deque<Entry> fetchq, rob;
+    std::vector<unsigned long long> rs, lsq;
+    unsigned long long rat[32];
+    bool rat_valid[32];
+    unsigned long long seq, now, resume;
+    bool blocked;
+    unsigned long long committed, mispredicts, occupancy;
+    unsigned long long stalls[STALL_NUM];
+
+    Entry & at(unsigned long long s) {
+        return rob[s - rob.front().seq];
+    }
+    bool ready(unsigned long long src) {
+        if (src == NEVER || rob.empty() || src < rob.front().seq)
+            return true;
+        return at(src).done <= now;
+    }
+    unsigned long long rename(unsigned r) {
+        return r && rat_valid[r] ? rat[r] : NEVER;
+    }
+    static Kind kind_of(unsigned opcode) {
+        if (opcode == 0x3)
+            return LOAD;
+        if (opcode == 0x23)
+            return STORE;
+        if (opcode == 0x63 || opcode == 0x67 || opcode == 0x6F)
+            return BRANCH;
+        return ALU;
+    }
+    static unsigned size_of(unsigned code) {
+        return 1 << (code >> 12 & 0x3);
+    }
+    void fetch() {
+        if (blocked || now < resume)
+            return;
+        for (unsigned i = 0; i < cfg.width && !ret; ++i) {
+            if (fetchq.size() >= cfg.width * 4)
+                return;
+            unsigned cur_pc = pc.read();
+            Inst * cur = run_inst();
+            Entry e;
+            e.seq = seq++;
+            e.kind = kind_of(cur->opcode());
+            e.dest = cur->rd();
+            e.src1 = cur->rs1();
+            e.src2 = cur->rs2();
+            e.addr = cur->mem_addr();
+            e.size = size_of(cur->code);
+            e.fetched = now;
+            e.done = NEVER;
+            e.issued = false;
+            e.mispredict = bubble;
+            delete cur;
+            fetchq.push_back(e);
+            if (e.mispredict) {
+                ++mispredicts;
+                blocked = true;
+                return;
+            }
+            if (e.kind == BRANCH && pc.read() != cur_pc + 4)
+                return;
+        }
+    }
+    void dispatch() {
+        unsigned num = 0;
+        Stall why = FRONTEND;
+        while (num < cfg.width && !fetchq.empty() && fetchq.front().fetched < now) {
+            Entry & e = fetchq.front();
+            bool mem_op = e.kind == LOAD || e.kind == STORE;
+            if (rob.size() >= cfg.rob_size) {
+                why = ROB_FULL;
+                break;
+            }
+            if (mem_op && lsq.size() >= cfg.lsq_size) {
+                why = LSQ_FULL;
+                break;
+            }
+            if (!mem_op && rs.size() >= cfg.rs_size) {
+                why = RS_FULL;
+                break;
+            }
+            e.src1 = rename(e.src1);
+            e.src2 = rename(e.src2);
+            if (e.dest) {
+                rat[e.dest] = e.seq;
+                rat_valid[e.dest] = true;
+            }
+            (mem_op ? lsq : rs).push_back(e.seq);
+            rob.push_back(e);
+            fetchq.pop_front();
+            ++num;
+        }
+        if (!num)
+            ++stalls[why];
+    }
+    bool overlap(const Entry & a, const Entry & b) {
+        return a.addr < b.addr + b.size && b.addr < a.addr + a.size;
+    }
+    bool load_ready(const Entry & e) {
+        for (unsigned long long s: lsq) {
+            if (s >= e.seq)
+                break;
+            Entry & st = at(s);
+            if (st.kind != STORE)
+                continue;
+            if (!st.issued)
+                return false;
+            if (overlap(st, e) && st.done > now)
+                return false;
+        }
+        return true;
+    }
+    void resolve(Entry & e) {
+        if (e.mispredict && !cfg.commit_recovery) {
+            blocked = false;
+            resume = e.done + cfg.penalty;
+        }
+    }
+    void issue() {
+        unsigned num = 0, ports = 0;
+        for (auto it = rs.begin(); it != rs.end() && num < cfg.width; ) {
+            Entry & e = at(*it);
+            if (ready(e.src1) && ready(e.src2)) {
+                e.issued = true;
+                e.done = now + 1;
+                resolve(e);
+                it = rs.erase(it);
+                ++num;
+            } else
+                ++it;
+        }
+        for (unsigned long long s: lsq) {
+            if (num >= cfg.width || ports >= cfg.mem_ports)
+                break;
+            Entry & e = at(s);
+            if (e.issued || !ready(e.src1) || !ready(e.src2))
+                continue;
+            if (e.kind == LOAD && !load_ready(e))
+                continue;
+            e.issued = true;
+            e.done = now + (e.kind == LOAD ? cfg.load_latency : 1);
+            ++num;
+            ++ports;
+        }
+    }
+    void commit() {
+        for (unsigned i = 0; i < cfg.width && !rob.empty(); ++i) {
+            Entry & e = rob.front();
+            if (!e.issued || e.done > now)
+                return;
+            if (e.dest && rat_valid[e.dest] && rat[e.dest] == e.seq)
+                rat_valid[e.dest] = false;
+            if (e.kind == LOAD || e.kind == STORE)
+                lsq.erase(lsq.begin());
+            if (e.mispredict && cfg.commit_recovery) {
+                blocked = false;
+                resume = now + cfg.penalty;
+            }
+            rob.pop_front();
+            ++committed;
+        }
+    }
+public:
+    OoOCore(const OoOConfig & cfg): cfg(cfg), seq(0), now(0), resume(0), blocked(false),
+        committed(0), mispredicts(0), occupancy(0) {
+        for (int i = 0; i < 32; ++i)
+            rat_valid[i] = false;
+        for (int i = 0; i < STALL_NUM; ++i)
+            stalls[i] = 0;
+    }
+    void run() {
+        while (!ret || !fetchq.empty() || !rob.empty()) {
+            commit();
+            issue();
+            dispatch();
+            fetch();
+            occupancy += rob.size();
+            ++now;
+        }
+        cycle += now;
+    }
+    void report(std::ostream & os) {
+        static const char * name[STALL_NUM] = {"frontend", "rob_full", "rs_full", "lsq_full"};
+        os << "cycles: " << now << std::endl;
+        os << "instructions: " << committed << std::endl;
+        if (now) {
+            os << "IPC: " << (double) committed / now << std::endl;
+            os << "ROB occupancy: " << (double) occupancy / now << std::endl;
+        }
+        os << "mispredicts: " << mispredicts << std::endl;
+        for (int i = 0; i < STALL_NUM; ++i)
+            os << "stall " << name[i] << ": " << stalls[i] << std::endl;
+    }
+};
+
+#endif
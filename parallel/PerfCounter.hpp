@@ -0,0 +1,107 @@
+#ifndef PERFCOUNTER_HPP
+#define PERFCOUNTER_HPP 1
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+class PerfCounters {
+private:
+    struct Event {
+        const char * name;
+        unsigned type;
+        unsigned long long config;
+    };
+    static const int EVENT_NUM = 7;
+    static const Event * events() {
+        static const Event list[EVENT_NUM] = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {"L1d-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+            {"L1i-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1I |
+                PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+            {"LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {"iTLB-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_ITLB |
+                PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+        };
+        return list;
+    }
+    int fd[EVENT_NUM];
+    int err[EVENT_NUM];
+public:
+    PerfCounters() {
+        const Event * ev = events();
+        for (int i = 0; i < EVENT_NUM; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = ev[i].type;
+            attr.config = ev[i].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            err[i] = fd[i] < 0 ? errno : 0;
+        }
+    }
+    ~PerfCounters() {
+        for (int i = 0; i < EVENT_NUM; ++i)
+            if (fd[i] >= 0)
+                close(fd[i]);
+    }
+    bool good() const {
+        for (int i = 0; i < EVENT_NUM; ++i)
+            if (fd[i] >= 0)
+                return true;
+        return false;
+    }
+    const char * error() const {
+        return std::strerror(err[0]);
+    }
+    void start() {
+        for (int i = 0; i < EVENT_NUM; ++i)
+            if (fd[i] >= 0) {
+                ioctl(fd[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+    }
+    void stop() {
+        for (int i = 0; i < EVENT_NUM; ++i)
+            if (fd[i] >= 0)
+                ioctl(fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    void report(std::ostream & os, unsigned long long insts) {
+        const Event * ev = events();
+        os << std::fixed;
+        for (int i = 0; i < EVENT_NUM; ++i) {
+            os << "host " << std::left << std::setw(14) << ev[i].name << std::right;
+            unsigned long long val[3];
+            if (fd[i] < 0) {
+                os << "unavailable (" << std::strerror(err[i]) << ")" << std::endl;
+                continue;
+            }
+            if (read(fd[i], val, sizeof(val)) != sizeof(val) || !val[2]) {
+                os << "not counted" << std::endl;
+                continue;
+            }
+            double count = val[2] < val[1] ? (double) val[0] * val[1] / val[2] : val[0];
+            os << std::setw(18) << std::setprecision(0) << count << std::setw(12)
+               << std::setprecision(3) << (insts ? count / insts : 0.0) << " per inst";
+            if (val[2] < val[1])
+                os << " (scaled, " << std::setprecision(1) << val[2] * 100.0 / val[1] << "%)";
+            os << std::endl;
+        }
+        os << std::defaultfloat;
+    }
+};
+
+#endif
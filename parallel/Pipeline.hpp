@@ -0,0 +1,65 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP 1
+
+#include "Inst.hpp"
+
+void tick(bool fetch = true) {
+    stall = false;
+    bubble = false;
+    if (inst[WB]->code) {
+        ++instret;
+        COUNT_RETIRE(inst[WB]->code);
+    }
+    inst[WB]->write_back();
+    delete inst[WB];
+    inst[MEM]->mem_access();
+    inst[WB] = inst[MEM];
+    inst[EX]->execute();
+    inst[MEM] = inst[EX];
+    if (bubble) {
+        COUNT(BUBBLES);
+        delete inst[ID];
+        Cause cause = inst[MEM]->opcode() == 0x67 ? JALR_FLUSH : BRANCH_FLUSH;
+        inst[EX] = new NOP(cause, inst[MEM]->inst_pc);
+        inst[ID] = new NOP(cause, inst[MEM]->inst_pc);
+    } else {
+        inst[ID]->inst_decode();
+        if (stall) {
+            COUNT(STALLS);
+            inst[EX] = new NOP(LOAD_USE, inst[MEM]->inst_pc);
+        } else if (!fetch) {
+            inst[EX] = inst[ID];
+            inst[ID] = new NOP;
+        } else {
+            inst[EX] = inst[ID];
+            unsigned cur_pc = pc.read();
+            unsigned code = mem.read_dword(cur_pc);
+            inst[IF] = Inst::parse(code);
+            inst[IF]->inst_pc = cur_pc;
+            inst[IF]->pc_modify();
+            inst[ID] = inst[IF];
+        }
+    }
+    ++cycle;
+}
+
+bool drained() {
+    for (int i = ID; i <= WB; ++i)
+        if (inst[i]->code)
+            return false;
+    return true;
+}
+
+unsigned in_flight() {
+    unsigned n = 0;
+    for (int i = ID; i <= WB; ++i)
+        n += inst[i]->code != 0;
+    return n;
+}
+
+void drain() {
+    while (!ret && !drained())
+        tick(false);
+}
+
+#endif
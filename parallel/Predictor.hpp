@@ -2,13 +2,14 @@
 #define PREDICTOR_HPP 1
 
 #include <cstring>
+#include "Serialize.hpp"
 
 class Predictor {
 private:
     unsigned hist;
     int tab[4];
 public:
-    Predictor() {
+    Predictor(): hist(0) {
         std::memset(tab, 0, sizeof(tab));
     }
     bool predict() {
@@ -25,6 +26,14 @@ public:
         hist <<= 1;
         hist |= taken;
     }
+    void save(std::ostream & os) {
+        put(os, hist);
+        put(os, tab);
+    }
+    void load(std::istream & is) {
+        get(is, hist);
+        get(is, tab);
+    }
 };
 
 #endif
\ No newline at end of file
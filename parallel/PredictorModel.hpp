@@ -0,0 +1,114 @@
+#ifndef PREDICTORMODEL_HPP
+#define PREDICTORMODEL_HPP 1
+
+#include "Predictor.hpp"
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <unordered_map>
+
+class PredictorModel {
+public:
+    unsigned long long branches, correct;
+    PredictorModel(): branches(0), correct(0) {}
+    virtual bool predict(unsigned pc) = 0;
+    virtual void update(unsigned pc, bool taken) = 0;
+    void access(unsigned pc, bool taken) {
+        ++branches;
+        correct += predict(pc) == taken;
+        update(pc, taken);
+    }
+    virtual ~PredictorModel() {}
+    static PredictorModel * create(const std::string & desc);
+};
+
+class PerPcModel: public PredictorModel {
+private:
+    std::unordered_map<unsigned, Predictor> pred;
+public:
+    bool predict(unsigned pc) {
+        return pred[pc].predict();
+    }
+    void update(unsigned pc, bool taken) {
+        pred[pc].update(taken);
+    }
+};
+
+class CounterTable {
+protected:
+    std::vector<unsigned char> tab;
+    unsigned mask;
+    CounterTable(unsigned bits): tab(1U << bits, 1), mask((1U << bits) - 1) {}
+    bool get(unsigned idx) {
+        return tab[idx & mask] >= 2;
+    }
+    void set(unsigned idx, bool taken) {
+        unsigned char & c = tab[idx & mask];
+        if (taken && c != 3)
+            ++c;
+        if (!taken && c != 0)
+            --c;
+    }
+};
+
+class BimodalModel: public PredictorModel, private CounterTable {
+public:
+    BimodalModel(unsigned bits): CounterTable(bits) {}
+    bool predict(unsigned pc) {
+        return get(pc >> 2);
+    }
+    void update(unsigned pc, bool taken) {
+        set(pc >> 2, taken);
+    }
+};
+
+class GshareModel: public PredictorModel, private CounterTable {
+private:
+    unsigned hist, hist_mask;
+public:
+    GshareModel(unsigned bits, unsigned hist_bits): CounterTable(bits), hist(0),
+        hist_mask((1U << hist_bits) - 1) {}
+    bool predict(unsigned pc) {
+        return get(pc >> 2 ^ hist);
+    }
+    void update(unsigned pc, bool taken) {
+        set(pc >> 2 ^ hist, taken);
+        hist = (hist << 1 | taken) & hist_mask;
+    }
+};
+
+class LocalModel: public PredictorModel, private CounterTable {
+private:
+    std::vector<unsigned> hist;
+    unsigned idx_mask, hist_bits;
+public:
+    LocalModel(unsigned idx_bits, unsigned hist_bits): CounterTable(idx_bits + hist_bits),
+        hist(1U << idx_bits, 0), idx_mask((1U << idx_bits) - 1), hist_bits(hist_bits) {}
+    unsigned index(unsigned pc) {
+        unsigned i = pc >> 2 & idx_mask;
+        return i << hist_bits | (hist[i] & ((1U << hist_bits) - 1));
+    }
+    bool predict(unsigned pc) {
+        return get(index(pc));
+    }
+    void update(unsigned pc, bool taken) {
+        set(index(pc), taken);
+        unsigned & h = hist[pc >> 2 & idx_mask];
+        h = h << 1 | taken;
+    }
+};
+
+PredictorModel * PredictorModel::create(const std::string & desc) {
+    unsigned a = 0, b = 0;
+    if (desc == "pc")
+        return new PerPcModel;
+    if (std::sscanf(desc.c_str(), "bimodal:%u", &a) == 1 && a < 28)
+        return new BimodalModel(a);
+    if (std::sscanf(desc.c_str(), "gshare:%u:%u", &a, &b) == 2 && a < 28 && b <= a)
+        return new GshareModel(a, b);
+    if (std::sscanf(desc.c_str(), "local:%u:%u", &a, &b) == 2 && a + b < 28)
+        return new LocalModel(a, b);
+    return NULL;
+}
+
+#endif
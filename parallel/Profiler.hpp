@@ -0,0 +1,134 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP 1
+
+#include "Inst.hpp"
+#include "Symbol.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
+
+class Profiler {
+private:
+    struct PcStat {
+        unsigned long long count, cycles;
+    };
+    struct Node {
+        unsigned func, parent;
+        unsigned long long cycles, calls;
+        std::map<unsigned, unsigned> child;
+    };
+    struct FuncStat {
+        unsigned long long self, total, calls;
+    };
+    const SymbolTable & sym;
+    std::unordered_map<unsigned, PcStat> pcs;
+    std::vector<Node> tree;
+    unsigned cur;
+    bool calling;
+    unsigned enter(unsigned func) {
+        auto it = tree[cur].child.find(func);
+        if (it != tree[cur].child.end())
+            return it->second;
+        unsigned id = tree.size();
+        tree[cur].child[func] = id;
+        tree.push_back(Node());
+        tree.back().func = func;
+        tree.back().parent = cur;
+        tree.back().cycles = 0;
+        tree.back().calls = 0;
+        return id;
+    }
+    std::string path(unsigned id) {
+        std::string ret = sym.lookup(tree[id].func);
+        while (id) {
+            id = tree[id].parent;
+            ret = sym.lookup(tree[id].func) + ";" + ret;
+        }
+        return ret;
+    }
+    unsigned long long total(unsigned id, std::map<unsigned, FuncStat> & func,
+                             std::multiset<unsigned> & active) {
+        unsigned long long sum = tree[id].cycles;
+        unsigned f = tree[id].func;
+        func[f].self += tree[id].cycles;
+        func[f].calls += tree[id].calls;
+        active.insert(f);
+        for (auto & it: tree[id].child)
+            sum += total(it.second, func, active);
+        active.erase(active.find(f));
+        if (!active.count(f))
+            func[f].total += sum;
+        return sum;
+    }
+public:
+    Profiler(const SymbolTable & sym): sym(sym), cur(0), calling(false) {
+        tree.push_back(Node());
+        tree[0].func = sym.start(0);
+        tree[0].parent = 0;
+        tree[0].cycles = 0;
+        tree[0].calls = 1;
+    }
+    void account(Inst * wb) {
+        PcStat & stat = pcs[wb->inst_pc];
+        ++stat.cycles;
+        ++tree[cur].cycles;
+        if (!wb->code)
+            return;
+        ++stat.count;
+        if (calling) {
+            cur = enter(sym.start(wb->inst_pc));
+            ++tree[cur].calls;
+            calling = false;
+        }
+        unsigned op = wb->opcode();
+        if ((op == 0x6F || op == 0x67) && wb->rd() == 1)
+            calling = true;
+        else if (op == 0x67 && wb->rd() == 0 && wb->rs1() == 1 && cur)
+            cur = tree[cur].parent;
+    }
+    void folded(std::ostream & os) {
+        for (unsigned id = 0; id < tree.size(); ++id)
+            if (tree[id].cycles)
+                os << path(id) << " " << tree[id].cycles << "\n";
+    }
+    void histogram(std::ostream & os) {
+        std::vector<std::pair<unsigned, PcStat>> list(pcs.begin(), pcs.end());
+        std::sort(list.begin(), list.end(),
+            [](const std::pair<unsigned, PcStat> & a, const std::pair<unsigned, PcStat> & b) {
+                return a.first < b.first;
+            });
+        os << "pc,symbol,count,cycles\n";
+        for (auto & it: list)
+            os << std::hex << it.first << std::dec << "," << sym.lookup(it.first) << ","
+               << it.second.count << "," << it.second.cycles << "\n";
+    }
+    void report(std::ostream & os) {
+        std::map<unsigned, FuncStat> func;
+        std::multiset<unsigned> active;
+        unsigned long long all = total(0, func, active);
+        std::vector<std::pair<unsigned, FuncStat>> list(func.begin(), func.end());
+        std::sort(list.begin(), list.end(),
+            [](const std::pair<unsigned, FuncStat> & a, const std::pair<unsigned, FuncStat> & b) {
+                return a.second.total > b.second.total;
+            });
+        os << std::left << std::setw(24) << "function" << std::right
+           << std::setw(14) << "inclusive" << std::setw(14) << "exclusive" << std::setw(12) << "calls"
+           << std::setw(9) << "incl%" << std::setw(9) << "excl%" << std::endl;
+        os << std::fixed << std::setprecision(2);
+        for (auto & it: list) {
+            const FuncStat & f = it.second;
+            os << std::left << std::setw(24) << sym.lookup(it.first) << std::right
+               << std::setw(14) << f.total << std::setw(14) << f.self << std::setw(12) << f.calls
+               << std::setw(9) << (all ? f.total * 100.0 / all : 0.0)
+               << std::setw(9) << (all ? f.self * 100.0 / all : 0.0) << std::endl;
+        }
+        os << std::defaultfloat;
+    }
+};
+
+#endif
@@ -1,11 +1,193 @@
 #include <iostream>
+#include <fstream>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <thread>
 #include "Inst.hpp"
+#include "Pipeline.hpp"
+#include "Checkpoint.hpp"
+#include "Sampler.hpp"
+#include "Interval.hpp"
+#include "OoO.hpp"
+#include "DualIssue.hpp"
+#include "Symbol.hpp"
+#include "CpiStack.hpp"
+#include "StatStream.hpp"
+#include "Telemetry.hpp"
+#include "Profiler.hpp"
+#include "BranchReport.hpp"
+#include "Trace.hpp"
+#include "ReuseDistance.hpp"
+#include "Dataflow.hpp"
+#include "Heatmap.hpp"
+#include "PerfCounter.hpp"
+#include "Core.hpp"
+#include "Lockstep.hpp"
 using namespace std;
 
-int main() {
+void trace_retire(TraceWriter & trace, Inst * wb) {
+    if (!wb->code)
+        return;
+    TraceRecord r;
+    r.pc = wb->inst_pc;
+    r.code = wb->code;
+    r.flags = 0;
+    unsigned rd = wb->rd();
+    if (rd && wb->forward(WB, rd, r.value))
+        r.flags |= T_RD;
+    unsigned op = wb->opcode();
+    if (op == 0x3 || op == 0x23) {
+        r.addr = wb->mem_addr();
+        r.data = wb->mem_data();
+        r.flags |= T_MEM;
+    }
+    bool taken, miss;
+    if (wb->outcome(taken, miss))
+        r.flags |= T_BRANCH | (taken ? T_TAKEN : 0) | (miss ? T_MISS : 0);
+    trace.record(r);
+}
+
+int main(int argc, char * argv[]) {
+    const char * ckpt_file = NULL;
+    unsigned long long ckpt_interval = 0;
+    bool resume = false;
+    Sampler * sampler = NULL;
+    unsigned long long ff, warm, detail;
+    unsigned long long interval = 0;
+    unsigned workers = thread::hardware_concurrency();
+    OoOConfig ooo_cfg;
+    bool ooo = false;
+    const char * stats_file = NULL;
+    SymbolTable sym;
+    CpiStack * cpi_stack = NULL;
+    const char * stream_file = NULL;
+    unsigned long long stream_period = 0;
+    bool stream_by_inst = false;
+    string telemetry_name;
+    Profiler * profiler = NULL;
+    string profile_prefix;
+    bool branch_report = false;
+    unsigned alias_bits = 10;
+    const char * trace_file = NULL;
+    ReuseAnalysis * reuse = NULL;
+    string reuse_prefix;
+    bool limit_study = false;
+    DataflowConfig df_cfg;
+    Heatmap * heatmap = NULL;
+    string heat_prefix;
+    bool summary = false;
+    bool host_counters = false;
+    CoreBase * core = NULL;
+    unsigned lanes = 0, lane_addr = 0;
+    bool lane_patch = false;
+    char * end;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:i:rs:p:j:o:Rdx:y:kt:T:mM:f:bB:w:u:lL:H:vPC:S:")) != -1) {
+        switch (opt) {
+            case 'c': ckpt_file = optarg; break;
+            case 'i': ckpt_interval = strtoull(optarg, NULL, 0); break;
+            case 'r': resume = true; break;
+            case 's':
+                if (sscanf(optarg, "%llu,%llu,%llu", &ff, &warm, &detail) != 3 || !detail) {
+                    cerr << "-s expects ff,warm,detail" << endl;
+                    return 1;
+                }
+                sampler = new Sampler(ff, warm, detail);
+                break;
+            case 'p': interval = strtoull(optarg, NULL, 0); break;
+            case 'j': workers = strtoul(optarg, NULL, 0); break;
+            case 'o':
+                if (sscanf(optarg, "%u,%u,%u,%u", &ooo_cfg.width, &ooo_cfg.rob_size,
+                        &ooo_cfg.rs_size, &ooo_cfg.lsq_size) != 4 || !ooo_cfg.width ||
+                        !ooo_cfg.rob_size || !ooo_cfg.rs_size || !ooo_cfg.lsq_size) {
+                    cerr << "-o expects width,rob,rs,lsq" << endl;
+                    return 1;
+                }
+                ooo = true;
+                break;
+            case 'R': ooo_cfg.commit_recovery = true; break;
+            case 'd': dual = true; break;
+            case 'x': stats_file = optarg; break;
+            case 'y':
+                if (!sym.load(optarg)) {
+                    cerr << "cannot read symbols from " << optarg << endl;
+                    return 1;
+                }
+                break;
+            case 'k': cpi_stack = new CpiStack(sym); break;
+            case 't':
+                stream_period = strtoull(optarg, &end, 0);
+                stream_by_inst = *end == 'i';
+                break;
+            case 'T': stream_file = optarg; break;
+            case 'm': telemetry_name = "/riscv_sim." + to_string(getpid()); break;
+            case 'M': telemetry_name = optarg; break;
+            case 'f':
+                profile_prefix = optarg;
+                profiler = new Profiler(sym);
+                break;
+            case 'b': branch_report = true; break;
+            case 'B':
+                alias_bits = strtoul(optarg, NULL, 0);
+                if (alias_bits >= 32) {
+                    cerr << "-B expects fewer than 32 bits" << endl;
+                    return 1;
+                }
+                break;
+            case 'w': trace_file = optarg; break;
+            case 'u':
+                reuse_prefix = optarg;
+                reuse = new ReuseAnalysis;
+                break;
+            case 'l': limit_study = true; break;
+            case 'v': summary = true; break;
+            case 'P': host_counters = true; break;
+            case 'S': {
+                int n = sscanf(optarg, "%u,%i", &lanes, (int *) &lane_addr);
+                if (n < 1 || !lanes) {
+                    cerr << "-S expects lanes[,addr]" << endl;
+                    return 1;
+                }
+                lane_patch = n == 2;
+                break;
+            }
+            case 'C':
+                core = make_core(optarg);
+                if (!core) {
+                    cerr << "unknown core " << optarg << ", expected one of";
+                    core_names(cerr);
+                    return 1;
+                }
+                break;
+            case 'H':
+                heat_prefix = optarg;
+                heatmap = new Heatmap;
+                break;
+            case 'L':
+                if (sscanf(optarg, "%u,%u,%u,%u", &df_cfg.alu, &df_cfg.load, &df_cfg.store,
+                           &df_cfg.branch) < 1) {
+                    cerr << "-L expects alu,load,store,branch" << endl;
+                    return 1;
+                }
+                break;
+            default:
+                cerr << "usage: " << argv[0]
+                     << " [-c checkpoint] [-i interval] [-r] [-s ff,warm,detail]"
+                     << " [-p interval [-j workers]] [-o width,rob,rs,lsq [-R]] [-d] [-x stats]"
+                     << " [-y dump] [-k] [-t period[i] -T csv]"
+                     << " [-m | -M shm] [-f profile] [-b [-B bits]]"
+                     << " [-w trace] [-u reuse] [-l [-L alu,load,store,branch]] [-H heatmap]"
+                     << " [-v] [-P] [-C core] [-S lanes[,addr]]" << endl;
+                return 1;
+        }
+    }
+
     branch = 0;
     correct = 0;
-    mem.init();
+    cycle = 0;
+    instret = 0;
     reg[0].set_zero();
     pc.write(0);
     ret = false;
@@ -14,32 +196,216 @@ int main() {
     inst[MEM] = new NOP;
     inst[WB] = new NOP;
 
-    while (!ret) {
-        stall = false;
-        bubble = false;
-        inst[WB]->write_back();
-        delete inst[WB];
-        inst[MEM]->mem_access();
-        inst[WB] = inst[MEM];
-        inst[EX]->execute();
-        inst[MEM] = inst[EX];
-        if (bubble) {
-            delete inst[ID];
-            inst[EX] = new NOP;
-            inst[ID] = new NOP;
-        } else {
-            inst[ID]->inst_decode();
-            if (stall)
-                inst[EX] = new NOP;
-            else {
-                inst[EX] = inst[ID];
-                unsigned cur_pc = pc.read();
-                unsigned code = mem.read_dword(cur_pc);
-                inst[IF] = Inst::parse(code);
-                inst[IF]->pc_modify();
-                inst[ID] = inst[IF];
-            }
+    ofstream ckpt;
+    if (resume) {
+        if (!ckpt_file) {
+            cerr << "-r requires -c" << endl;
+            return 1;
+        }
+        ifstream fin(ckpt_file, ios::binary);
+        streamoff end = 0;
+        while (load_checkpoint(fin))
+            end = fin.tellg();
+        if (!end) {
+            cerr << "cannot restore from " << ckpt_file << endl;
+            return 1;
+        }
+        fin.close();
+        if (truncate(ckpt_file, end)) {
+            cerr << "cannot truncate " << ckpt_file << endl;
+            return 1;
+        }
+        ckpt.open(ckpt_file, ios::binary | ios::app);
+    } else {
+        mem.init();
+        if (ckpt_file)
+            ckpt.open(ckpt_file, ios::binary | ios::trunc);
+    }
+
+    if (lanes) {
+        run_lockstep(lanes, lane_addr, lane_patch, cout, cerr);
+        return 0;
+    }
+
+    BranchReport * branches = NULL;
+    if (branch_report)
+        branches = new BranchReport(sym, alias_bits);
+    Dataflow * dataflow = NULL;
+    if (limit_study)
+        dataflow = new Dataflow(sym, df_cfg);
+    TraceWriter * trace = NULL;
+    if (trace_file) {
+        trace = new TraceWriter(trace_file);
+        if (!trace->good()) {
+            cerr << "cannot write " << trace_file << endl;
+            delete trace;
+            return 1;
+        }
+    }
+    StatStream * stream = NULL;
+    if (stream_file && stream_period) {
+        stream = new StatStream(stream_file, stream_period, stream_by_inst);
+        if (!stream->good()) {
+            cerr << "cannot write " << stream_file << endl;
+            delete stream;
+            delete trace;
+            return 1;
+        }
+    }
+
+    Telemetry * telemetry = NULL;
+    if (!telemetry_name.empty()) {
+        telemetry = new Telemetry(telemetry_name);
+        if (!telemetry->good()) {
+            cerr << "cannot create shared memory " << telemetry_name << endl;
+            delete telemetry;
+            telemetry = NULL;
+        }
+    }
+
+    PerfCounters * perf = NULL;
+    if (host_counters) {
+        perf = new PerfCounters;
+        if (!perf->good()) {
+            cerr << "host performance counters unavailable: " << perf->error() << endl;
+            delete perf;
+            perf = NULL;
+        }
+    }
+    unsigned long long start_instret = instret;
+    if (perf)
+        perf->start();
+
+    if (dual) {
+        for (int i = ID; i <= WB; ++i)
+            inst2[i] = new NOP;
+        while (!ret) {
+            tick_dual();
+            if (stream)
+                stream->sample();
+            if (telemetry)
+                telemetry->sample(cycle, instret, branch, correct, pc.read());
         }
+        report_dual(cerr);
+    }
+    if (ooo) {
+        OoOCore core(ooo_cfg);
+        core.run();
+        core.report(cerr);
+    }
+    if (interval) {
+        IntervalSim sim(interval, workers ? workers : 1);
+        sim.run();
+        sim.report(cerr);
+    }
+    if (sampler) {
+        sampler->run();
+        sampler->report(cerr);
+        delete sampler;
+    }
+    if (core) {
+        drain();
+        core->run(~0ULL);
+        if (!core->error().empty()) {
+            cerr << core->error() << endl;
+            delete stream;
+            delete trace;
+            return 1;
+        }
+        core->report(cerr);
+        delete core;
+    }
+    bool hooked = cpi_stack || profiler || branches || trace || reuse || dataflow || heatmap ||
+                  stream || telemetry || (ckpt_interval && ckpt.is_open());
+    if (!hooked)
+        while (!ret)
+            tick();
+    while (!ret) {
+        if (cpi_stack)
+            cpi_stack->account(inst[WB]);
+        if (profiler)
+            profiler->account(inst[WB]);
+        if (branches)
+            branches->account(inst[WB]);
+        if (trace)
+            trace_retire(*trace, inst[WB]);
+        if (reuse)
+            reuse->account(inst[WB]);
+        if (dataflow)
+            dataflow->account(inst[WB]);
+        if (heatmap)
+            heatmap->account(inst[WB], cycle);
+        tick();
+        if (stream)
+            stream->sample();
+        if (telemetry)
+            telemetry->sample(cycle, instret, branch, correct, pc.read());
+        if (ckpt_interval && ckpt.is_open() && cycle % ckpt_interval == 0)
+            save_checkpoint(ckpt);
+    }
+    if (perf) {
+        perf->stop();
+        perf->report(cerr, instret - start_instret);
+        delete perf;
+    }
+
+    if (stream) {
+        stream->snapshot();
+        delete stream;
+    }
+    if (telemetry) {
+        telemetry->snapshot(cycle, instret, branch, correct, pc.read());
+        delete telemetry;
+    }
+    if (cpi_stack) {
+        cpi_stack->report(cerr);
+        delete cpi_stack;
+    }
+    delete trace;
+    if (branches) {
+        branches->report(cerr);
+        delete branches;
+    }
+    if (dataflow) {
+        dataflow->report(cerr);
+        delete dataflow;
+    }
+    if (heatmap) {
+        ofstream lines(heat_prefix + ".lines"), pages(heat_prefix + ".pages"),
+            heat(heat_prefix + ".heat");
+        heatmap->line_csv(lines);
+        heatmap->page_csv(pages);
+        heatmap->heat_csv(heat);
+        heatmap->report(cerr);
+        delete heatmap;
+    }
+    if (reuse) {
+        ofstream hist(reuse_prefix + ".reuse"), wss(reuse_prefix + ".wss");
+        reuse->histogram(hist);
+        reuse->working_set(wss);
+        reuse->report(cerr);
+        delete reuse;
+    }
+    if (profiler) {
+        ofstream folded(profile_prefix + ".folded"), pcs(profile_prefix + ".pcs");
+        profiler->folded(folded);
+        profiler->histogram(pcs);
+        profiler->report(cerr);
+        delete profiler;
+    }
+#ifdef STATS
+    if (stats_file) {
+        ofstream fout(stats_file);
+        report_stats(fout, cycle, instret);
+    } else
+        report_stats(cerr, cycle, instret);
+#else
+    if (stats_file)
+        cerr << "built without -DSTATS, no statistics written" << endl;
+#endif
+    if (summary) {
+        cerr << "cycles: " << cycle << endl;
+        cerr << "instructions: " << instret << endl;
     }
 
     cout << (reg[10].read() & 0xFF) << endl;
@@ -49,5 +415,8 @@ int main() {
     delete inst[EX];
     delete inst[MEM];
     delete inst[WB];
+    if (dual)
+        for (int i = ID; i <= WB; ++i)
+            delete inst2[i];
     return 0;
-}
\ No newline at end of file
+}
@@ -6,7 +6,7 @@ private:
     unsigned storage;
     bool zero;
 public:
-    Register(): zero(false) {}
+    constexpr Register(): storage(0), zero(false) {}
     unsigned read() {
         return zero ? 0 : storage;
     }
@@ -0,0 +1,164 @@
+#ifndef REUSEDISTANCE_HPP
+#define REUSEDISTANCE_HPP 1
+
+#include "Inst.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+class ReuseDistance {
+private:
+    static const unsigned BUCKETS = 33;
+    unsigned line_bits;
+    struct Line {
+        unsigned time;
+        unsigned long long window;
+    };
+    std::vector<unsigned> tree;
+    std::unordered_map<unsigned, Line> last;
+    unsigned now;
+    unsigned long long accesses, window_id, window_lines;
+    void add(unsigned i, int val) {
+        for (++i; i <= tree.size(); i += i & -i)
+            tree[i - 1] += val;
+    }
+    unsigned sum(unsigned i) {
+        unsigned ret = 0;
+        for (; i; i -= i & -i)
+            ret += tree[i - 1];
+        return ret;
+    }
+    void compact() {
+        std::vector<std::pair<unsigned, unsigned>> live;
+        for (auto & it: last)
+            live.push_back({it.second.time, it.first});
+        std::sort(live.begin(), live.end());
+        if (live.size() * 2 > tree.size())
+            tree.resize(tree.size() * 2);
+        std::fill(tree.begin(), tree.end(), 0);
+        for (unsigned i = 0; i < live.size(); ++i) {
+            last[live[i].second].time = i;
+            add(i, 1);
+        }
+        now = live.size();
+    }
+public:
+    unsigned long long cold;
+    unsigned long long hist[BUCKETS];
+    std::vector<unsigned long long> wss;
+    ReuseDistance(unsigned line):
+        line_bits(0), tree(1 << 20), now(0), accesses(0), window_id(0),
+        window_lines(0), cold(0) {
+        while ((1U << line_bits) < line)
+            ++line_bits;
+        for (unsigned i = 0; i < BUCKETS; ++i)
+            hist[i] = 0;
+    }
+    void access(unsigned addr) {
+        unsigned blk = addr >> line_bits;
+        if (now == tree.size())
+            compact();
+        auto it = last.find(blk);
+        if (it == last.end()) {
+            ++cold;
+            it = last.insert({blk, Line{now, 0}}).first;
+        } else {
+            unsigned dist = sum(now) - sum(it->second.time + 1);
+            unsigned b = 0;
+            while (dist >> b)
+                ++b;
+            ++hist[b];
+            add(it->second.time, -1);
+            it->second.time = now;
+        }
+        add(now, 1);
+        ++now;
+        ++accesses;
+        if (it->second.window != window_id + 1) {
+            it->second.window = window_id + 1;
+            ++window_lines;
+        }
+    }
+    unsigned long long total() const {
+        return accesses;
+    }
+    unsigned long long misses(unsigned lines) const {
+        unsigned long long ret = cold;
+        unsigned b = 0;
+        while ((1U << b) < lines)
+            ++b;
+        for (unsigned i = b + 1; i < BUCKETS; ++i)
+            ret += hist[i];
+        return ret;
+    }
+    unsigned line_size() const {
+        return 1U << line_bits;
+    }
+    void histogram(std::ostream & os, const char * name) {
+        for (unsigned i = 0; i < BUCKETS; ++i)
+            if (hist[i])
+                os << name << "," << (i ? 1U << (i - 1) : 0) << "," << (i ? (1ULL << i) - 1 : 0)
+                   << "," << hist[i] << "\n";
+        os << name << ",cold,cold," << cold << "\n";
+    }
+    void flush() {
+        wss.push_back(window_lines);
+        window_lines = 0;
+        ++window_id;
+    }
+};
+
+class ReuseAnalysis {
+private:
+    unsigned long long window, count;
+public:
+    ReuseDistance inst, data;
+    ReuseAnalysis(unsigned line = 64, unsigned long long window = 100000):
+        window(window), count(0), inst(line), data(line) {}
+    void account(Inst * wb) {
+        if (!wb->code)
+            return;
+        inst.access(wb->inst_pc);
+        unsigned op = wb->opcode();
+        if (op == 0x3 || op == 0x23)
+            data.access(wb->mem_addr());
+        if (++count % window == 0) {
+            inst.flush();
+            data.flush();
+        }
+    }
+    void report(std::ostream & os) {
+        os << "accesses: inst " << inst.total() << ", data " << data.total() << std::endl;
+        os << "distinct lines: inst " << inst.cold << ", data " << data.cold << std::endl;
+        os << std::setw(12) << "cache" << std::setw(12) << "inst miss%" << std::setw(12)
+           << "data miss%" << std::endl;
+        os << std::fixed << std::setprecision(3);
+        for (unsigned lines = 1; lines <= (1U << 16); lines <<= 1) {
+            os << std::setw(10) << lines * data.line_size() / 1024.0 << "KB"
+               << std::setw(12) << (inst.total() ? inst.misses(lines) * 100.0 / inst.total() : 0.0)
+               << std::setw(12) << (data.total() ? data.misses(lines) * 100.0 / data.total() : 0.0)
+               << std::endl;
+            if (lines >= inst.cold && lines >= data.cold)
+                break;
+        }
+        os << std::defaultfloat;
+    }
+    void histogram(std::ostream & os) {
+        os << "stream,min,max,count\n";
+        inst.histogram(os, "inst");
+        data.histogram(os, "data");
+    }
+    void working_set(std::ostream & os) {
+        if (count % window) {
+            inst.flush();
+            data.flush();
+        }
+        os << "window,inst_lines,data_lines\n";
+        for (std::size_t i = 0; i < inst.wss.size(); ++i)
+            os << i * window << "," << inst.wss[i] << "," << data.wss[i] << "\n";
+    }
+};
+
+#endif
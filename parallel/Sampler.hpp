@@ -0,0 +1,54 @@
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP 1
+
+#include "Inst.hpp"
+#include "Pipeline.hpp"
+#include "Functional.hpp"
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+class Sampler {
+private:
+    unsigned long long ff, warm, detail;
+    std::vector<double> cpi;
+    void simulate(unsigned long long num) {
+        unsigned long long end = instret + num;
+        while (!ret && instret < end)
+            tick();
+    }
+public:
+    Sampler(unsigned long long ff, unsigned long long warm, unsigned long long detail):
+        ff(ff), warm(warm), detail(detail) {}
+    void run() {
+        while (!ret) {
+            fast_forward(ff);
+            simulate(warm);
+            unsigned long long start_cycle = cycle, start_inst = instret;
+            simulate(detail);
+            if (instret - start_inst == detail)
+                cpi.push_back((double) (cycle - start_cycle) / detail);
+            drain();
+        }
+    }
+    void report(std::ostream & os) {
+        unsigned n = cpi.size();
+        os << "samples: " << n << std::endl;
+        if (!n)
+            return;
+        double mean = 0, var = 0;
+        for (double x: cpi)
+            mean += x;
+        mean /= n;
+        for (double x: cpi)
+            var += (x - mean) * (x - mean);
+        var = n > 1 ? var / (n - 1) : 0;
+        double err = 1.96 * std::sqrt(var / n);
+        os << "instructions: " << instret << std::endl;
+        os << "CPI: " << mean << " +- " << err << " (95%)" << std::endl;
+        os << "cycles: " << (unsigned long long) (mean * instret) << " +- "
+           << (unsigned long long) (err * instret) << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SERIALIZE_HPP
+#define SERIALIZE_HPP 1
+
+#include <iostream>
+
+template <class T>
+void put(std::ostream & os, const T & val) {
+    os.write((const char *) &val, sizeof(T));
+}
+
+template <class T>
+void get(std::istream & is, T & val) {
+    is.read((char *) &val, sizeof(T));
+}
+
+#endif
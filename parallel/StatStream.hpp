@@ -0,0 +1,115 @@
+#ifndef STATSTREAM_HPP
+#define STATSTREAM_HPP 1
+
+#include "Inst.hpp"
+#include "Stats.hpp"
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class StatStream {
+private:
+    struct Snapshot {
+        unsigned long long cycle, instret;
+        unsigned branch, correct;
+#ifdef STATS
+        unsigned long long counter[COUNTER_NUM];
+#endif
+    };
+    std::ofstream fout;
+    unsigned long long period, next;
+    bool by_inst;
+    std::vector<Snapshot> ring;
+    unsigned head, tail;
+    bool done;
+    std::mutex lock;
+    std::condition_variable not_empty, not_full;
+    std::thread writer;
+    void write(const Snapshot & cur, const Snapshot & last) {
+        unsigned long long cycles = cur.cycle - last.cycle;
+        unsigned long long insts = cur.instret - last.instret;
+        unsigned branches = cur.branch - last.branch;
+        fout << cur.cycle << ',' << cur.instret << ','
+             << (cycles ? (double) insts / cycles : 0.0) << ','
+             << (branches ? (double) (cur.correct - last.correct) / branches : 0.0);
+#ifdef STATS
+        for (int i = 0; i < COUNTER_NUM; ++i)
+            fout << ',' << cur.counter[i] - last.counter[i];
+#endif
+        fout << '\n';
+    }
+    void work() {
+        Snapshot last = Snapshot();
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            not_empty.wait(guard, [this] { return head != tail || done; });
+            if (head == tail)
+                break;
+            Snapshot cur = ring[head];
+            head = (head + 1) % ring.size();
+            not_full.notify_one();
+            guard.unlock();
+            write(cur, last);
+            last = cur;
+            guard.lock();
+        }
+        fout.flush();
+    }
+    void push(const Snapshot & snap) {
+        std::unique_lock<std::mutex> guard(lock);
+        not_full.wait(guard, [this] { return (tail + 1) % ring.size() != head; });
+        ring[tail] = snap;
+        tail = (tail + 1) % ring.size();
+        not_empty.notify_one();
+    }
+public:
+    StatStream(const char * file, unsigned long long period, bool by_inst, unsigned capacity = 1024):
+        fout(file), period(period), next(period), by_inst(by_inst), ring(capacity + 1),
+        head(0), tail(0), done(false) {
+        fout << "cycle,instret,ipc,branch_accuracy";
+#ifdef STATS
+        for (int i = 0; i < COUNTER_NUM; ++i)
+            fout << ',' << counter_name[i];
+#endif
+        fout << '\n';
+        writer = std::thread(&StatStream::work, this);
+    }
+    ~StatStream() {
+        close();
+    }
+    bool good() const {
+        return (bool) fout;
+    }
+    void sample() {
+        if ((by_inst ? instret : cycle) < next)
+            return;
+        next += period;
+        snapshot();
+    }
+    void snapshot() {
+        Snapshot snap;
+        snap.cycle = cycle;
+        snap.instret = instret;
+        snap.branch = branch;
+        snap.correct = correct;
+#ifdef STATS
+        for (int i = 0; i < COUNTER_NUM; ++i)
+            snap.counter[i] = counter[i];
+#endif
+        push(snap);
+    }
+    void close() {
+        if (!writer.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            done = true;
+        }
+        not_empty.notify_one();
+        writer.join();
+    }
+};
+
+#endif
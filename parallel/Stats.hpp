@@ -0,0 +1,57 @@
+#ifndef STATS_HPP
+#define STATS_HPP 1
+
+#include <iostream>
+#include <map>
+#include <string>
+#include "../common/Decode.hpp"
+
+enum Counter {STALLS, BUBBLES, LOADS, STORES, FWD_EXMEM, FWD_MEMWB, COUNTER_NUM};
+
+const char * counter_name[COUNTER_NUM] = {
+    "stalls", "bubbles", "loads", "stores", "fwd_exmem", "fwd_memwb"
+};
+
+#ifdef STATS
+
+thread_local unsigned long long counter[COUNTER_NUM];
+thread_local unsigned long long op_count[OP_NUM];
+
+#define COUNT(c) (++counter[c])
+#define COUNT_IF(cond, c) ((cond) ? (void) ++counter[c] : (void) 0)
+#define COUNT_RETIRE(code) count_retire(code)
+
+void count_retire(unsigned code) {
+    ++op_count[decode(code)];
+    unsigned opcode = code & 0x7F;
+    if (opcode == 0x3)
+        ++counter[LOADS];
+    else if (opcode == 0x23)
+        ++counter[STORES];
+}
+
+void report_stats(std::ostream & os, unsigned long long cycles, unsigned long long insts) {
+    os << "{\"cycles\": " << cycles << ", \"instructions\": " << insts;
+    if (insts)
+        os << ", \"cpi\": " << (double) cycles / insts;
+    for (int i = 0; i < COUNTER_NUM; ++i)
+        os << ", \"" << counter_name[i] << "\": " << counter[i];
+    std::map<std::string, unsigned long long> ops;
+    for (unsigned k = 0; k < OP_NUM; ++k)
+        if (op_count[k])
+            ops[isa[k].name] = op_count[k];
+    os << ", \"opcodes\": {";
+    for (auto it = ops.begin(); it != ops.end(); ++it)
+        os << (it == ops.begin() ? "" : ", ") << "\"" << it->first << "\": " << it->second;
+    os << "}}" << std::endl;
+}
+
+#else
+
+#define COUNT(c) ((void) 0)
+#define COUNT_IF(cond, c) ((void) 0)
+#define COUNT_RETIRE(code) ((void) 0)
+
+#endif
+
+#endif
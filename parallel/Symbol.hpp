@@ -0,0 +1,57 @@
+#ifndef SYMBOL_HPP
+#define SYMBOL_HPP 1
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+
+class SymbolTable {
+private:
+    std::map<unsigned, std::string> sym;
+    std::string unknown;
+public:
+    SymbolTable(): unknown("?") {}
+    bool load(const char * file) {
+        std::ifstream fin(file);
+        if (!fin)
+            return false;
+        std::string line;
+        bool skip = false;
+        while (std::getline(fin, line)) {
+            if (line.compare(0, 23, "Disassembly of section ") == 0) {
+                std::string sec = line.substr(23);
+                skip = sec.compare(0, 6, ".debug") == 0 || sec.compare(0, 8, ".comment") == 0 ||
+                    sec.compare(0, 6, ".riscv") == 0;
+                continue;
+            }
+            if (skip)
+                continue;
+            std::size_t lt = line.find(" <"), gt = line.rfind(">:");
+            if (lt == std::string::npos || gt == std::string::npos || gt < lt)
+                continue;
+            std::istringstream is(line.substr(0, lt));
+            unsigned addr;
+            if (is >> std::hex >> addr)
+                sym[addr] = line.substr(lt + 2, gt - lt - 2);
+        }
+        return true;
+    }
+    bool empty() const {
+        return sym.empty();
+    }
+    unsigned start(unsigned addr) const {
+        auto it = sym.upper_bound(addr);
+        return it == sym.begin() ? 0 : (--it)->first;
+    }
+    unsigned end(unsigned addr) const {
+        auto it = sym.upper_bound(addr);
+        return it == sym.end() ? ~0U : it->first;
+    }
+    const std::string & lookup(unsigned addr) const {
+        auto it = sym.upper_bound(addr);
+        return it == sym.begin() ? unknown : (--it)->second;
+    }
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP 1
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+const unsigned TELEMETRY_MAGIC = 0x4D4C4554;
+const unsigned TELEMETRY_SLOTS = 64;
+
+struct TelemetrySample {
+    unsigned long long cycle, instret, branch, correct, host_ns;
+    unsigned pc;
+};
+
+struct TelemetrySlot {
+    std::atomic<unsigned long long> stamp;
+    TelemetrySample data;
+};
+
+struct TelemetryRing {
+    unsigned magic, slots;
+    std::atomic<unsigned long long> head;
+    std::atomic<bool> finished;
+    TelemetrySlot slot[TELEMETRY_SLOTS];
+};
+
+unsigned long long host_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+bool read_telemetry(const TelemetryRing * ring, unsigned long long n, TelemetrySample & out) {
+    const TelemetrySlot & s = ring->slot[n % ring->slots];
+    unsigned long long stamp = s.stamp.load(std::memory_order_acquire);
+    if (stamp != 2 * n + 2)
+        return false;
+    out = s.data;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.stamp.load(std::memory_order_relaxed) == stamp;
+}
+
+class Telemetry {
+private:
+    std::string name;
+    TelemetryRing * ring;
+    unsigned long long mask;
+public:
+    Telemetry(const std::string & name, unsigned shift = 16):
+        name(name), ring(NULL), mask((1ULL << shift) - 1) {
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0)
+            return;
+        if (ftruncate(fd, sizeof(TelemetryRing)) == 0) {
+            void * p = mmap(NULL, sizeof(TelemetryRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+                ring = (TelemetryRing *) p;
+        }
+        ::close(fd);
+        if (!ring)
+            return;
+        std::memset((void *) ring, 0, sizeof(TelemetryRing));
+        ring->slots = TELEMETRY_SLOTS;
+        ring->magic = TELEMETRY_MAGIC;
+    }
+    ~Telemetry() {
+        if (!ring)
+            return;
+        ring->finished.store(true, std::memory_order_release);
+        munmap(ring, sizeof(TelemetryRing));
+        shm_unlink(name.c_str());
+    }
+    bool good() const {
+        return ring;
+    }
+    void sample(unsigned long long cycle, unsigned long long instret,
+                unsigned branch, unsigned correct, unsigned pc) {
+        if (!(cycle & mask))
+            snapshot(cycle, instret, branch, correct, pc);
+    }
+    void snapshot(unsigned long long cycle, unsigned long long instret,
+                  unsigned branch, unsigned correct, unsigned pc) {
+        TelemetrySample data;
+        data.cycle = cycle;
+        data.instret = instret;
+        data.branch = branch;
+        data.correct = correct;
+        data.pc = pc;
+        publish(data);
+    }
+    void publish(TelemetrySample & data) {
+        unsigned long long n = ring->head.load(std::memory_order_relaxed);
+        TelemetrySlot & s = ring->slot[n % TELEMETRY_SLOTS];
+        data.host_ns = host_ns();
+        s.stamp.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.data = data;
+        s.stamp.store(2 * n + 2, std::memory_order_release);
+        ring->head.store(n + 1, std::memory_order_release);
+    }
+};
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP 1
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const unsigned TRACE_MAGIC = 0x52545652;
+const unsigned TRACE_BLOCK = 1 << 20;
+
+enum TraceFlag {
+    T_SEQ = 1, T_CODE = 2, T_RD = 4, T_MEM = 8, T_BRANCH = 16, T_TAKEN = 32, T_MISS = 64
+};
+
+struct TraceRecord {
+    unsigned pc, code, value, addr, data;
+    unsigned char flags;
+};
+
+class TraceCodec {
+protected:
+    static const unsigned CACHE = 4096;
+    unsigned last_pc, last_addr;
+    unsigned reg_val[32];
+    unsigned cache_pc[CACHE], cache_code[CACHE];
+    void reset() {
+        last_pc = ~0U - 3;
+        last_addr = 0;
+        std::memset(reg_val, 0, sizeof(reg_val));
+        std::memset(cache_pc, 0xFF, sizeof(cache_pc));
+        std::memset(cache_code, 0, sizeof(cache_code));
+    }
+    static unsigned zigzag(unsigned x) {
+        return x << 1 ^ (unsigned) ((int) x >> 31);
+    }
+    static unsigned unzigzag(unsigned x) {
+        return x >> 1 ^ (0U - (x & 1));
+    }
+};
+
+class TraceWriter: public TraceCodec {
+private:
+    std::ofstream fout;
+    std::vector<unsigned char> buf[2];
+    unsigned active;
+    bool pending, done;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::thread writer;
+    void varint(unsigned x) {
+        std::vector<unsigned char> & b = buf[active];
+        while (x >= 0x80) {
+            b.push_back(x | 0x80);
+            x >>= 7;
+        }
+        b.push_back(x);
+    }
+    void work() {
+        std::vector<unsigned char> out;
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            cv.wait(guard, [this] { return pending || done; });
+            if (!pending)
+                break;
+            std::vector<unsigned char> & in = buf[active ^ 1];
+            guard.unlock();
+            uLongf len = compressBound(in.size());
+            out.resize(len);
+            int err = compress2(out.data(), &len, in.data(), in.size(), Z_BEST_SPEED);
+            if (err != Z_OK && fout) {
+                std::cerr << "trace compression failed: " << zError(err) << std::endl;
+                fout.setstate(std::ios::badbit);
+            }
+            if (fout) {
+                unsigned raw = in.size(), packed = len;
+                fout.write((const char *) &raw, sizeof(raw));
+                fout.write((const char *) &packed, sizeof(packed));
+                fout.write((const char *) out.data(), packed);
+            }
+            in.clear();
+            guard.lock();
+            pending = false;
+            cv.notify_all();
+        }
+        fout.flush();
+    }
+    void flush() {
+        std::unique_lock<std::mutex> guard(lock);
+        cv.wait(guard, [this] { return !pending; });
+        active ^= 1;
+        pending = true;
+        cv.notify_all();
+        reset();
+    }
+public:
+    TraceWriter(const char * file): fout(file, std::ios::binary), active(0),
+        pending(false), done(false) {
+        fout.write((const char *) &TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        buf[0].reserve(TRACE_BLOCK + 64);
+        buf[1].reserve(TRACE_BLOCK + 64);
+        reset();
+        writer = std::thread(&TraceWriter::work, this);
+    }
+    ~TraceWriter() {
+        if (!buf[active].empty())
+            flush();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            done = true;
+        }
+        cv.notify_all();
+        writer.join();
+    }
+    bool good() const {
+        return (bool) fout;
+    }
+    void record(const TraceRecord & r) {
+        unsigned char flags = r.flags & (T_RD | T_MEM | T_BRANCH | T_TAKEN | T_MISS);
+        if (r.pc == last_pc + 4)
+            flags |= T_SEQ;
+        unsigned slot = r.pc >> 2 & (CACHE - 1);
+        if (cache_pc[slot] != r.pc || cache_code[slot] != r.code) {
+            flags |= T_CODE;
+            cache_pc[slot] = r.pc;
+            cache_code[slot] = r.code;
+        }
+        buf[active].push_back(flags);
+        if (!(flags & T_SEQ))
+            varint(zigzag(r.pc - last_pc));
+        if (flags & T_CODE)
+            varint(r.code);
+        if (flags & T_RD) {
+            unsigned rd = r.code >> 7 & 0x1F;
+            varint(zigzag(r.value - reg_val[rd]));
+            reg_val[rd] = r.value;
+        }
+        if (flags & T_MEM) {
+            varint(zigzag(r.addr - last_addr));
+            varint(r.data);
+            last_addr = r.addr;
+        }
+        last_pc = r.pc;
+        if (buf[active].size() >= TRACE_BLOCK)
+            flush();
+    }
+};
+
+class TraceReader: public TraceCodec {
+private:
+    const unsigned char * map;
+    std::size_t size, off;
+    std::vector<unsigned char> block;
+    std::size_t pos;
+    bool fail() {
+        off = size;
+        block.clear();
+        pos = 0;
+        return false;
+    }
+    bool varint(unsigned & x) {
+        x = 0;
+        for (int shift = 0; shift < 32; shift += 7) {
+            if (pos >= block.size())
+                return fail();
+            unsigned char b = block[pos++];
+            x |= (unsigned) (b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return fail();
+    }
+    bool load_block() {
+        unsigned raw, packed;
+        if (off + 8 > size)
+            return fail();
+        std::memcpy(&raw, map + off, 4);
+        std::memcpy(&packed, map + off + 4, 4);
+        off += 8;
+        if (packed > size - off || raw > TRACE_BLOCK + 64)
+            return fail();
+        block.resize(raw);
+        uLongf len = raw;
+        if (uncompress(block.data(), &len, map + off, packed) != Z_OK || len != raw)
+            return fail();
+        off += packed;
+        pos = 0;
+        reset();
+        return true;
+    }
+public:
+    TraceReader(const char * file): map(NULL), size(0), off(0), pos(0) {
+        int fd = open(file, O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= 4) {
+            void * p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                map = (const unsigned char *) p;
+                size = st.st_size;
+                madvise(p, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+        unsigned magic;
+        if (map)
+            std::memcpy(&magic, map, 4);
+        if (!map || magic != TRACE_MAGIC) {
+            if (map)
+                munmap((void *) map, size);
+            map = NULL;
+            return;
+        }
+        off = 4;
+    }
+    ~TraceReader() {
+        if (map)
+            munmap((void *) map, size);
+    }
+    bool good() const {
+        return map;
+    }
+    bool next(TraceRecord & r) {
+        while (pos >= block.size())
+            if (!load_block())
+                return false;
+        unsigned char flags = block[pos++];
+        unsigned x;
+        r.flags = flags;
+        if (flags & T_SEQ)
+            r.pc = last_pc + 4;
+        else if (varint(x))
+            r.pc = last_pc + unzigzag(x);
+        else
+            return false;
+        unsigned slot = r.pc >> 2 & (CACHE - 1);
+        if (flags & T_CODE) {
+            if (!varint(x))
+                return false;
+            cache_pc[slot] = r.pc;
+            cache_code[slot] = x;
+        }
+        r.code = cache_code[slot];
+        r.value = r.addr = r.data = 0;
+        if (flags & T_RD) {
+            if (!varint(x))
+                return false;
+            unsigned rd = r.code >> 7 & 0x1F;
+            r.value = reg_val[rd] += unzigzag(x);
+        }
+        if (flags & T_MEM) {
+            if (!varint(x))
+                return false;
+            r.addr = last_addr += unzigzag(x);
+            if (!varint(r.data))
+                return false;
+        }
+        last_pc = r.pc;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include "Telemetry.hpp"
+using namespace std;
+
+int main(int argc, char * argv[]) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " pid|name [seconds]" << endl;
+        return 1;
+    }
+    string name = argv[1];
+    if (name[0] != '/')
+        name = "/riscv_sim." + name;
+    double period = argc > 2 ? atof(argv[2]) : 1;
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        cerr << "cannot attach to " << name << endl;
+        return 1;
+    }
+    void * p = mmap(NULL, sizeof(TelemetryRing), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        cerr << "cannot map " << name << endl;
+        return 1;
+    }
+    const TelemetryRing * ring = (const TelemetryRing *) p;
+    if (ring->magic != TELEMETRY_MAGIC) {
+        cerr << name << " is not a simulator telemetry ring" << endl;
+        return 1;
+    }
+
+    TelemetrySample last = TelemetrySample(), cur;
+    bool have_last = false;
+    cout << fixed << setprecision(3);
+    while (true) {
+        bool finished = ring->finished.load(std::memory_order_acquire);
+        unsigned long long head = ring->head.load(std::memory_order_acquire);
+        if (head && read_telemetry(ring, head - 1, cur)) {
+            cout << "cycle " << cur.cycle << "  pc " << hex << setw(8) << setfill('0') << cur.pc
+                 << dec << setfill(' ');
+            if (have_last && cur.host_ns > last.host_ns) {
+                unsigned long long insts = cur.instret - last.instret;
+                unsigned long long cycles = cur.cycle - last.cycle;
+                cout << "  MIPS " << insts * 1000.0 / (cur.host_ns - last.host_ns);
+                if (cycles)
+                    cout << "  IPC " << (double) insts / cycles;
+            }
+            if (cur.branch)
+                cout << "  branch " << (double) cur.correct / cur.branch * 100 << "%";
+            cout << endl;
+            last = cur;
+            have_last = true;
+        }
+        if (finished)
+            break;
+        usleep(period * 1000000);
+    }
+    munmap(p, sizeof(TelemetryRing));
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "Trace.hpp"
+#include "Cache.hpp"
+#include "PredictorModel.hpp"
+using namespace std;
+
+enum EventKind {TAKEN, NOT_TAKEN, LOAD, STORE, FETCH};
+
+struct Event {
+    unsigned addr;
+    unsigned char kind;
+};
+
+struct Model {
+    string desc;
+    PredictorModel * pred;
+    Cache * cache;
+    bool inst;
+};
+
+const unsigned BATCH = 1 << 16;
+const unsigned SLOTS = 4;
+
+struct Batch {
+    vector<Event> ev;
+    unsigned pending;
+};
+
+Batch ring[SLOTS];
+unsigned long long produced;
+bool finished;
+mutex ring_lock;
+condition_variable cv;
+
+Cache * parse_cache(const string & desc, bool & inst) {
+    char kind;
+    unsigned size, ways, line;
+    if (sscanf(desc.c_str(), "%c:%u:%u:%u", &kind, &size, &ways, &line) != 4 ||
+            (kind != 'd' && kind != 'i') || !size || !ways || !line || (line & (line - 1)))
+        return NULL;
+    inst = kind == 'i';
+    return new Cache(size, ways, line);
+}
+
+void work(vector<Model *> models) {
+    unsigned long long next = 0;
+    while (true) {
+        unique_lock<mutex> guard(ring_lock);
+        cv.wait(guard, [next] { return next < produced || finished; });
+        if (next >= produced)
+            return;
+        Batch & b = ring[next % SLOTS];
+        guard.unlock();
+        for (Model * m: models) {
+            if (m->pred) {
+                for (const Event & e: b.ev)
+                    if (e.kind <= NOT_TAKEN)
+                        m->pred->access(e.addr, e.kind == TAKEN);
+            } else if (m->inst) {
+                for (const Event & e: b.ev)
+                    if (e.kind == FETCH)
+                        m->cache->access(e.addr);
+            } else {
+                for (const Event & e: b.ev)
+                    if (e.kind == LOAD || e.kind == STORE)
+                        m->cache->access(e.addr);
+            }
+        }
+        guard.lock();
+        if (!--b.pending)
+            cv.notify_all();
+        ++next;
+    }
+}
+
+int main(int argc, char * argv[]) {
+    vector<string> preds, caches;
+    unsigned workers = thread::hardware_concurrency();
+    int opt;
+    while ((opt = getopt(argc, argv, "p:c:j:")) != -1) {
+        switch (opt) {
+            case 'p': preds.push_back(optarg); break;
+            case 'c': caches.push_back(optarg); break;
+            case 'j': workers = strtoul(optarg, NULL, 0); break;
+            default:
+                cerr << "usage: " << argv[0]
+                     << " [-p predictor]... [-c {d|i}:size:ways:line]... [-j workers] trace" << endl;
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        cerr << "no trace file given" << endl;
+        return 1;
+    }
+    if (!workers)
+        workers = 1;
+    if (preds.empty() && caches.empty()) {
+        preds.push_back("pc");
+        for (unsigned b = 4; b <= 14; b += 2)
+            preds.push_back("bimodal:" + to_string(b));
+        for (unsigned b = 8; b <= 14; b += 2)
+            for (unsigned h = 2; h <= b; h += 4)
+                preds.push_back("gshare:" + to_string(b) + ":" + to_string(h));
+        for (unsigned b = 4; b <= 10; b += 2)
+            for (unsigned h: {1, 2, 4, 8})
+                preds.push_back("local:" + to_string(b) + ":" + to_string(h));
+        for (unsigned size = 1024; size <= 65536; size *= 4)
+            for (unsigned ways: {1, 2, 4, 8})
+                caches.push_back("d:" + to_string(size) + ":" + to_string(ways) + ":64");
+        for (unsigned size = 1024; size <= 16384; size *= 4)
+            caches.push_back("i:" + to_string(size) + ":2:64");
+    }
+
+    vector<Model *> models;
+    bool need_fetch = false;
+    for (auto & d: preds) {
+        PredictorModel * p = PredictorModel::create(d);
+        if (!p) {
+            cerr << "bad predictor " << d << endl;
+            return 1;
+        }
+        models.push_back(new Model{d, p, NULL, false});
+    }
+    for (auto & d: caches) {
+        bool inst;
+        Cache * c = parse_cache(d, inst);
+        if (!c) {
+            cerr << "bad cache " << d << endl;
+            return 1;
+        }
+        models.push_back(new Model{d, NULL, c, inst});
+        need_fetch |= inst;
+    }
+
+    TraceReader reader(argv[optind]);
+    if (!reader.good()) {
+        cerr << "cannot read trace " << argv[optind] << endl;
+        return 1;
+    }
+    if (workers > models.size())
+        workers = models.size();
+    vector<vector<Model *>> part(workers);
+    for (unsigned i = 0; i < models.size(); ++i)
+        part[i % workers].push_back(models[i]);
+    vector<thread> pool;
+    for (unsigned i = 0; i < workers; ++i)
+        pool.emplace_back(work, part[i]);
+
+    TraceRecord r;
+    unsigned long long insts = 0;
+    bool more = true;
+    while (more) {
+        Batch & b = ring[produced % SLOTS];
+        {
+            unique_lock<mutex> guard(ring_lock);
+            cv.wait(guard, [&b] { return !b.pending; });
+        }
+        b.ev.clear();
+        while (b.ev.size() + 2 <= BATCH && (more = reader.next(r))) {
+            ++insts;
+            if (need_fetch)
+                b.ev.push_back({r.pc, FETCH});
+            if ((r.flags & T_BRANCH) && (r.code & 0x7F) == 0x63)
+                b.ev.push_back({r.pc, (unsigned char) (r.flags & T_TAKEN ? TAKEN : NOT_TAKEN)});
+            if (r.flags & T_MEM)
+                b.ev.push_back({r.addr, (unsigned char) ((r.code & 0x7F) == 0x23 ? STORE : LOAD)});
+        }
+        lock_guard<mutex> guard(ring_lock);
+        b.pending = workers;
+        ++produced;
+        cv.notify_all();
+    }
+    {
+        lock_guard<mutex> guard(ring_lock);
+        finished = true;
+        cv.notify_all();
+    }
+    for (auto & t: pool)
+        t.join();
+
+    cout << "instructions: " << insts << endl;
+    cout << fixed << setprecision(3);
+    for (Model * m: models) {
+        cout << left << setw(20) << m->desc << right;
+        if (m->pred) {
+            PredictorModel * p = m->pred;
+            cout << setw(14) << p->branches << " branches"
+                 << setw(10) << (p->branches ? p->correct * 100.0 / p->branches : 0.0) << "%"
+                 << setw(10) << (insts ? (p->branches - p->correct) * 1000.0 / insts : 0.0)
+                 << " MPKI" << endl;
+        } else {
+            Cache * c = m->cache;
+            unsigned long long total = c->hits + c->misses;
+            cout << setw(14) << total << " accesses"
+                 << setw(10) << (total ? c->misses * 100.0 / total : 0.0) << "% miss"
+                 << setw(10) << (insts ? c->misses * 1000.0 / insts : 0.0) << " MPKI" << endl;
+        }
+        delete m->pred;
+        delete m->cache;
+        delete m;
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "Inst.hpp"
+#include "Core.hpp"
+using namespace std;
+
+const unsigned long long DEFAULT_LIMIT = 1000000000;
+
+struct Image {
+    vector<unsigned> pages;
+    vector<unsigned char> data;
+    long long mtime, size;
+    unsigned long long used;
+};
+
+class ImageCache {
+private:
+    map<string, shared_ptr<Image>> images;
+    unsigned capacity;
+    unsigned long long clock;
+    mutex lock;
+public:
+    ImageCache(unsigned capacity): capacity(capacity), clock(0) {}
+    bool load(const string & path, bool & cached) {
+        struct stat st;
+        if (stat(path.c_str(), &st) || !S_ISREG(st.st_mode))
+            return false;
+        long long mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        shared_ptr<Image> img;
+        {
+            lock_guard<mutex> guard(lock);
+            auto it = images.find(path);
+            if (it != images.end() && it->second->mtime == mtime &&
+                    it->second->size == st.st_size) {
+                img = it->second;
+                img->used = ++clock;
+            }
+        }
+        mem.clear();
+        cached = img != NULL;
+        if (img) {
+            for (size_t k = 0; k < img->pages.size(); ++k)
+                mem.write_page(img->pages[k], &img->data[k * Memory::PAGE_SIZE]);
+            return true;
+        }
+        ifstream fin(path);
+        if (!fin)
+            return false;
+        mem.init(fin);
+        if (fin.bad())
+            return false;
+        img = make_shared<Image>();
+        for (unsigned i = 0; i < Memory::PAGE_NUM; ++i)
+            if (mem.page_dirty(i)) {
+                img->pages.push_back(i);
+                img->data.insert(img->data.end(), mem.page(i), mem.page(i) + Memory::PAGE_SIZE);
+            }
+        img->mtime = mtime;
+        img->size = st.st_size;
+        lock_guard<mutex> guard(lock);
+        img->used = ++clock;
+        images[path] = img;
+        while (images.size() > capacity) {
+            auto victim = images.begin();
+            for (auto it = images.begin(); it != images.end(); ++it)
+                if (it->second->used < victim->second->used)
+                    victim = it;
+            images.erase(victim);
+        }
+        return true;
+    }
+};
+
+struct Connection {
+    int fd;
+    mutex lock;
+    Connection(int fd): fd(fd) {}
+    ~Connection() {
+        close(fd);
+    }
+    void reply(const string & line) {
+        lock_guard<mutex> guard(lock);
+        size_t done = 0;
+        while (done < line.size()) {
+            ssize_t n = write(fd, line.data() + done, line.size() - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return;
+            done += n;
+        }
+    }
+};
+
+struct Job {
+    shared_ptr<Connection> conn;
+    string line;
+};
+
+deque<Job> jobs;
+mutex job_lock;
+condition_variable job_cv;
+
+void submit(const Job & job) {
+    {
+        lock_guard<mutex> guard(job_lock);
+        jobs.push_back(job);
+    }
+    job_cv.notify_one();
+}
+
+Job take() {
+    unique_lock<mutex> guard(job_lock);
+    job_cv.wait(guard, [] { return !jobs.empty(); });
+    Job job = jobs.front();
+    jobs.pop_front();
+    return job;
+}
+
+string quote(const string & s) {
+    string ret = "\"";
+    for (char c: s) {
+        if (c == '"' || c == '\\')
+            ret += '\\';
+        if ((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            ret += buf;
+        } else
+            ret += c;
+    }
+    return ret + "\"";
+}
+
+void reset_state() {
+    for (int i = 1; i < 32; ++i)
+        reg[i].write(0);
+    pc.write(0);
+    ret = false;
+    branch = 0;
+    correct = 0;
+    cycle = 0;
+    instret = 0;
+    pred.clear();
+}
+
+string run_job(const string & line, ImageCache & images, unsigned long long max_limit) {
+    auto start = chrono::steady_clock::now();
+    map<string, string> args;
+    istringstream is(line);
+    string tok;
+    while (is >> tok) {
+        size_t eq = tok.find('=');
+        if (eq == string::npos)
+            args[""] = tok;
+        else
+            args[tok.substr(0, eq)] = tok.substr(eq + 1);
+    }
+    ostringstream os;
+    os << "{\"id\": " << quote(args["id"]);
+    string error;
+    unsigned long long limit = max_limit;
+    if (args.count("limit")) {
+        unsigned long long want = strtoull(args["limit"].c_str(), NULL, 0);
+        if (want && (!limit || want < limit))
+            limit = want;
+    }
+    string core_name = args.count("core") ? args["core"] : "base";
+    CoreBase * core = NULL;
+    bool cached = false;
+    if (args.count(""))
+        error = "expected key=value, got " + args[""];
+    else if (args["image"].empty())
+        error = "missing image";
+    else if (!(core = make_core(core_name)))
+        error = "unknown core " + core_name;
+    else if (!images.load(args["image"], cached))
+        error = "cannot read " + args["image"];
+    if (!error.empty()) {
+        delete core;
+        os << ", \"status\": \"error\", \"error\": " << quote(error) << "}\n";
+        return os.str();
+    }
+    reset_state();
+    core->run(limit ? limit : ~0ULL);
+    const char * status = !core->error().empty() ? "illegal" : ret ? "ok" : "limit";
+    os << ", \"status\": \"" << status << "\"";
+    if (!core->error().empty())
+        os << ", \"error\": " << quote(core->error());
+    os << ", \"result\": " << (reg[10].read() & 0xFF);
+    if (branch)
+        os << ", \"accuracy\": " << (double) correct / branch * 100;
+    os << ", \"cycles\": " << cycle << ", \"instructions\": " << instret
+       << ", \"cached\": " << (cached ? "true" : "false") << ", \"ms\": "
+       << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count()
+       << "}\n";
+    delete core;
+    return os.str();
+}
+
+void work(ImageCache & images, unsigned long long max_limit) {
+    reg[0].set_zero();
+    while (true) {
+        Job job = take();
+        job.conn->reply(run_job(job.line, images, max_limit));
+    }
+}
+
+void serve(int fd) {
+    shared_ptr<Connection> conn = make_shared<Connection>(fd);
+    string buf;
+    char chunk[4096];
+    while (true) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        buf.append(chunk, n);
+        size_t pos;
+        while ((pos = buf.find('\n')) != string::npos) {
+            string line = buf.substr(0, pos);
+            buf.erase(0, pos + 1);
+            if (line.find_first_not_of(" \t\r") != string::npos)
+                submit({conn, line});
+        }
+    }
+    if (buf.find_first_not_of(" \t\r") != string::npos)
+        submit({conn, buf});
+}
+
+int main(int argc, char * argv[]) {
+    unsigned workers = thread::hardware_concurrency();
+    unsigned capacity = 64;
+    unsigned long long max_limit = DEFAULT_LIMIT;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:c:l:")) != -1) {
+        switch (opt) {
+            case 'j': workers = strtoul(optarg, NULL, 0); break;
+            case 'c': capacity = strtoul(optarg, NULL, 0); break;
+            case 'l': max_limit = strtoull(optarg, NULL, 0); break;
+            default:
+                cerr << "usage: " << argv[0] << " [-j workers] [-c images] [-l cycles] socket"
+                     << endl;
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        cerr << "usage: " << argv[0] << " [-j workers] [-c images] [-l cycles] socket" << endl;
+        return 1;
+    }
+    const char * path = argv[optind];
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        cerr << "socket path too long: " << path << endl;
+        return 1;
+    }
+    strcpy(addr.sun_path, path);
+    signal(SIGPIPE, SIG_IGN);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (sockaddr *) &addr, sizeof(addr)) ||
+            listen(listener, 128)) {
+        cerr << "cannot listen on " << path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    ImageCache images(capacity ? capacity : 1);
+    vector<thread> pool;
+    for (unsigned i = 0; i < (workers ? workers : 1); ++i)
+        pool.emplace_back(work, ref(images), max_limit);
+    cerr << "listening on " << path << " with " << pool.size() << " workers" << endl;
+    while (true) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            cerr << "accept: " << strerror(errno) << endl;
+            break;
+        }
+        thread(serve, fd).detach();
+    }
+    close(listener);
+    unlink(path);
+    return 1;
+}
@@ -1,4 +1,7 @@
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include "../common/Decode.hpp"
 using namespace std;
 
 const unsigned END_ADDR = 0x30004;
@@ -105,16 +108,14 @@ class RTypeInst: public Inst {
 protected:
     unsigned src1, src2, dest;
 public:
-    static Inst * parse(unsigned code);
     void inst_decode() {
         IDEX_rval1 = reg[src1].read();
         IDEX_rval2 = reg[src2].read();
     }
-private:
-    void set(unsigned src1, unsigned src2, unsigned dest) {
-        this->src1 = src1;
-        this->src2 = src2;
-        this->dest = dest;
+    void set(const Fields & f) {
+        src1 = f.rs1;
+        src2 = f.rs2;
+        dest = f.rd;
     }
 };
 
@@ -123,16 +124,14 @@ protected:
     unsigned imm;
     unsigned src, dest, shamt;
 public:
-    static Inst * parse(unsigned code);
     void inst_decode() {
         IDEX_rval1 = reg[src].read();
     }
-private:
-    void set(unsigned imm, unsigned src, unsigned dest, unsigned shamt) {
-        this->imm = imm;
-        this->src = src;
-        this->dest = dest;
-        this->shamt = shamt;
+    void set(const Fields & f) {
+        imm = f.imm;
+        src = f.rs1;
+        dest = f.rd;
+        shamt = f.imm & 0x1F;
     }
 };
 
@@ -141,16 +140,14 @@ protected:
     unsigned imm;
     unsigned src1, src2;
 public:
-    static Inst * parse(unsigned code);
     void inst_decode() {
         IDEX_rval1 = reg[src1].read();
         IDEX_rval2 = reg[src2].read();
     }
-private:
-    void set(unsigned imm, unsigned src1, unsigned src2) {
-        this->imm = imm;
-        this->src1 = src1;
-        this->src2 = src2;
+    void set(const Fields & f) {
+        imm = f.imm;
+        src1 = f.rs1;
+        src2 = f.rs2;
     }
 };
 
@@ -159,16 +156,14 @@ protected:
     unsigned imm;
     unsigned src1, src2;
 public:
-    static Inst * parse(unsigned code);
     void inst_decode() {
         IDEX_rval1 = reg[src1].read();
         IDEX_rval2 = reg[src2].read();
     }
-private:
-    void set(unsigned imm, unsigned src1, unsigned src2) {
-        this->imm = imm;
-        this->src1 = src1;
-        this->src2 = src2;
+    void set(const Fields & f) {
+        imm = f.imm;
+        src1 = f.rs1;
+        src2 = f.rs2;
     }
 };
 
@@ -177,11 +172,9 @@ protected:
     unsigned imm;
     unsigned dest;
 public:
-    static Inst * parse(unsigned code);
-private:
-    void set(unsigned imm, unsigned dest) {
-        this->imm = imm;
-        this->dest = dest;
+    void set(const Fields & f) {
+        imm = f.imm;
+        dest = f.rd;
     }
 };
 
@@ -190,38 +183,15 @@ protected:
     unsigned imm;
     unsigned dest;
 public:
-    static Inst * parse(unsigned code);
-private:
-    void set(unsigned imm, unsigned dest) {
-        this->imm = imm;
-        this->dest = dest;
+    void set(const Fields & f) {
+        imm = f.imm;
+        dest = f.rd;
     }
 };
 
-Inst * Inst::parse(unsigned code) {
-    unsigned opcode = code & 0x7F;
-    if (opcode == 0x33)
-        return RTypeInst::parse(code);
-    else if (opcode == 0x67 || opcode == 0x3 || opcode == 0x13)
-        return ITypeInst::parse(code);
-    else if (opcode == 0x23)
-        return STypeInst::parse(code);
-    else if (opcode == 0x63)
-        return BTypeInst::parse(code);
-    else if (opcode == 0x37 || opcode == 0x17)
-        return UTypeInst::parse(code);
-    else if (opcode = 0x6F)
-        return JTypeInst::parse(code);
-}
-
-unsigned sgnext(unsigned imm, int hi) {
-    if (imm & (1 << hi))
-        imm |= 0xFFFFFFFF >> hi << hi;
-    return imm;
-}
-
 class LUI: public UTypeInst {
 public:
+    static const Op op = OP_LUI;
     void write_back() {
         reg[dest].load(imm);
     }
@@ -229,6 +199,7 @@ public:
 
 class AUIPC: public UTypeInst {
 public:
+    static const Op op = OP_AUIPC;
     void exec() {
         EXMEM_data = IDEX_inst_addr + imm;
     }
@@ -242,6 +213,7 @@ public:
 
 class JAL: public JTypeInst {
 public:
+    static const Op op = OP_JAL;
     void inst_fetch() {
         pc.load(pc.read() + imm);
     }
@@ -258,6 +230,7 @@ public:
 
 class JALR: public ITypeInst {
 public:
+    static const Op op = OP_JALR;
     void exec() {
         pc.load((IDEX_rval1 + imm) & 0xFFFFFFFE);
         EXMEM_data = IDEX_inst_addr + 4;
@@ -272,6 +245,7 @@ public:
 
 class BEQ: public BTypeInst {
 public:
+    static const Op op = OP_BEQ;
     void exec() {
         if (IDEX_rval1 == IDEX_rval2)
             pc.load(IDEX_inst_addr + imm);
@@ -280,6 +254,7 @@ public:
 
 class BNE: public BTypeInst {
 public:
+    static const Op op = OP_BNE;
     void exec() {
         if (IDEX_rval1 != IDEX_rval2)
             pc.load(IDEX_inst_addr + imm);
@@ -288,6 +263,7 @@ public:
 
 class BLT: public BTypeInst {
 public:
+    static const Op op = OP_BLT;
     void exec() {
         if ((int) IDEX_rval1 < (int) IDEX_rval2)
             pc.load(IDEX_inst_addr + imm);
@@ -296,6 +272,7 @@ public:
 
 class BGE: public BTypeInst {
 public:
+    static const Op op = OP_BGE;
     void exec() {
         if ((int) IDEX_rval1 >= (int) IDEX_rval2)
             pc.load(IDEX_inst_addr + imm);
@@ -304,6 +281,7 @@ public:
 
 class BLTU: public BTypeInst {
 public:
+    static const Op op = OP_BLTU;
     void exec() {
         if (IDEX_rval1 < IDEX_rval2)
             pc.load(IDEX_inst_addr + imm);
@@ -312,6 +290,7 @@ public:
 
 class BGEU: public BTypeInst {
 public:
+    static const Op op = OP_BGEU;
     void exec() {
         if (IDEX_rval1 >= IDEX_rval2)
             pc.load(IDEX_inst_addr + imm);
@@ -330,6 +309,7 @@ public:
 
 class LB: public LoadInst {
 public:
+    static const Op op = OP_LB;
     void mem_access() {
         MEMWB_data = sgnext(mem.read(EXMEM_addr), 7);
     }
@@ -337,6 +317,7 @@ public:
 
 class LH: public LoadInst {
 public:
+    static const Op op = OP_LH;
     void mem_access() {
         MEMWB_data = sgnext(mem.read_word(EXMEM_addr), 15);
     }
@@ -344,6 +325,7 @@ public:
 
 class LW: public LoadInst {
 public:
+    static const Op op = OP_LW;
     void mem_access() {
         MEMWB_data = mem.read_dword(EXMEM_addr);
     }
@@ -351,6 +333,7 @@ public:
 
 class LBU: public LoadInst {
 public:
+    static const Op op = OP_LBU;
     void mem_access() {
         MEMWB_data = mem.read(EXMEM_addr);
     }
@@ -358,6 +341,7 @@ public:
 
 class LHU: public LoadInst {
 public:
+    static const Op op = OP_LHU;
     void mem_access() {
         MEMWB_data = mem.read_word(EXMEM_addr);
     }
@@ -373,6 +357,7 @@ public:
 
 class SB: public StoreInst {
 public:
+    static const Op op = OP_SB;
     void exec() {
         EXMEM_addr = IDEX_rval1 + imm;
         EXMEM_data = IDEX_rval2;
@@ -388,6 +373,7 @@ public:
 
 class SH: public StoreInst {
 public:
+    static const Op op = OP_SH;
     void mem_access() {
         mem.load_word(EXMEM_addr, EXMEM_data);
     }
@@ -395,6 +381,7 @@ public:
 
 class SW: public StoreInst {
 public:
+    static const Op op = OP_SW;
     void mem_access() {
         mem.load_dword(EXMEM_addr, EXMEM_data);
     }
@@ -412,6 +399,7 @@ public:
 
 class ADDI: public ITypeCalcInst {
 public:
+    static const Op op = OP_ADDI;
     void exec() {
         EXMEM_data = IDEX_rval1 + imm;
     }
@@ -419,6 +407,7 @@ public:
 
 class SLTI: public ITypeCalcInst {
 public:
+    static const Op op = OP_SLTI;
     void exec() {
         EXMEM_data = (int) IDEX_rval1 < (int) imm;
     }
@@ -426,6 +415,7 @@ public:
 
 class SLTIU: public ITypeCalcInst {
 public:
+    static const Op op = OP_SLTIU;
     void exec() {
         EXMEM_data = IDEX_rval1 < imm;
     }
@@ -433,6 +423,7 @@ public:
 
 class XORI: public ITypeCalcInst {
 public:
+    static const Op op = OP_XORI;
     void exec() {
         EXMEM_data = IDEX_rval1 ^ imm;
     }
@@ -440,6 +431,7 @@ public:
 
 class ORI: public ITypeCalcInst {
 public:
+    static const Op op = OP_ORI;
     void exec() {
         EXMEM_data = IDEX_rval1 | imm;
     }
@@ -447,6 +439,7 @@ public:
 
 class ANDI: public ITypeCalcInst {
 public:
+    static const Op op = OP_ANDI;
     void exec() {
         EXMEM_data = IDEX_rval1 & imm;
     }
@@ -454,6 +447,7 @@ public:
 
 class SLLI: public ITypeCalcInst {
 public:
+    static const Op op = OP_SLLI;
     void exec() {
         EXMEM_data = IDEX_rval1 << shamt;
     }
@@ -461,6 +455,7 @@ public:
 
 class SRLI: public ITypeCalcInst {
 public:
+    static const Op op = OP_SRLI;
     void exec() {
         EXMEM_data = IDEX_rval1 >> shamt;
     }
@@ -468,6 +463,7 @@ public:
 
 class SRAI: public ITypeCalcInst {
 public:
+    static const Op op = OP_SRAI;
     void exec() {
         EXMEM_data = (int) IDEX_rval1 >> shamt;
     }
@@ -485,6 +481,7 @@ public:
 
 class ADD: public RTypeCalcInst {
 public:
+    static const Op op = OP_ADD;
     void exec() {
         EXMEM_data = IDEX_rval1 + IDEX_rval2;
     }
@@ -492,6 +489,7 @@ public:
 
 class SUB: public RTypeCalcInst {
 public:
+    static const Op op = OP_SUB;
     void exec() {
         EXMEM_data = IDEX_rval1 - IDEX_rval2;
     }
@@ -499,6 +497,7 @@ public:
 
 class SLL: public RTypeCalcInst {
 public:
+    static const Op op = OP_SLL;
     void exec() {
         EXMEM_data = IDEX_rval1 << (IDEX_rval2 & 0x1F);
     }
@@ -506,6 +505,7 @@ public:
 
 class SLT: public RTypeCalcInst {
 public:
+    static const Op op = OP_SLT;
     void exec() {
         EXMEM_data = (int) IDEX_rval1 < (int) IDEX_rval2;
     }
@@ -513,6 +513,7 @@ public:
 
 class SLTU: public RTypeCalcInst {
 public:
+    static const Op op = OP_SLTU;
     void exec() {
         EXMEM_data = IDEX_rval1 < IDEX_rval2;
     }
@@ -520,6 +521,7 @@ public:
 
 class XOR: public RTypeCalcInst {
 public:
+    static const Op op = OP_XOR;
     void exec() {
         EXMEM_data = IDEX_rval1 ^ IDEX_rval2;
     }
@@ -527,6 +529,7 @@ public:
 
 class SRL: public RTypeCalcInst {
 public:
+    static const Op op = OP_SRL;
     void exec() {
         EXMEM_data = IDEX_rval1 >> (IDEX_rval2 & 0x1F);
     }
@@ -534,6 +537,7 @@ public:
 
 class SRA: public RTypeCalcInst {
 public:
+    static const Op op = OP_SRA;
     void exec() {
         EXMEM_data = (int) IDEX_rval1 >> (IDEX_rval2 & 0x1F);
     }
@@ -541,6 +545,7 @@ public:
 
 class OR: public RTypeCalcInst {
 public:
+    static const Op op = OP_OR;
     void exec() {
         EXMEM_data = IDEX_rval1 | IDEX_rval2;
     }
@@ -548,150 +553,33 @@ public:
 
 class AND: public RTypeCalcInst {
 public:
+    static const Op op = OP_AND;
     void exec() {
         EXMEM_data = IDEX_rval1 & IDEX_rval2;
     }
 };
 
-Inst * RTypeInst::parse(unsigned code) {
-    RTypeInst * ret;
-    unsigned funct3 = code >> 12 & 0x7;
-    unsigned funct7 = code >> 25;
-    if (funct3 == 0 && funct7 == 0)
-        ret = new ADD;
-    else if (funct3 == 0 && funct7 == 0x20)
-        ret = new SUB;
-    else if (funct3 == 0x1)
-        ret = new SLL;
-    else if (funct3 == 0x2)
-        ret = new SLT;
-    else if (funct3 == 0x3)
-        ret = new SLTU;
-    else if (funct3 == 0x4)
-        ret = new XOR;
-    else if (funct3 == 0x5 && funct7 == 0)
-        ret = new SRL;
-    else if (funct3 == 0x5 && funct7 == 0x20)
-        ret = new SRA;
-    else if (funct3 == 0x6)
-        ret = new OR;
-    else if (funct3 == 0x7)
-        ret = new AND;
-    unsigned src1 = code >> 15 & 0x1F;
-    unsigned src2 = code >> 20 & 0x1F;
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(src1, src2, dest);
-    return (Inst *) ret;
-}
-
-Inst * ITypeInst::parse(unsigned code) {
-    ITypeInst * ret;
-    unsigned opcode = code & 0x7F;
-    unsigned funct3 = code >> 12 & 0x7;
-    unsigned funct7 = code >> 25;
-    if (opcode == 0x67)
-        ret = new JALR;
-    else if (opcode == 0x3) {
-        if (funct3 == 0)
-            ret = new LB;
-        else if (funct3 == 0x1)
-            ret = new LH;
-        else if (funct3 == 0x2)
-            ret = new LW;
-        else if (funct3 == 0x4)
-            ret = new LBU;
-        else if (funct3 == 0x5)
-            ret = new LHU;
-    } else if (opcode == 0x13) {
-        if (funct3 == 0)
-            ret = new ADDI;
-        else if (funct3 == 0x2)
-            ret = new SLTI;
-        else if (funct3 == 0x3)
-            ret = new SLTIU;
-        else if (funct3 == 0x4)
-            ret = new XORI;
-        else if (funct3 == 0x6)
-            ret = new ORI;
-        else if (funct3 == 0x7)
-            ret = new ANDI;
-        else if (funct3 == 0x1)
-            ret = new SLLI;
-        else if (funct3 == 0x5 && funct7 == 0)
-            ret = new SRLI;
-        else if (funct3 == 0x5 && funct7 == 0x20)
-            ret = new SRAI;
-    }
-    unsigned imm = sgnext(code >> 20, 11);
-    unsigned src = code >> 15 & 0x1F;
-    unsigned dest = code >> 7 & 0x1F;
-    unsigned shamt = imm & 0x1F;
-    ret->set(imm, src, dest, shamt);
-    return (Inst *) ret;
-}
-
-Inst * STypeInst::parse(unsigned code) {
-    STypeInst * ret;
-    unsigned funct3 = code >> 12 & 0x7;
-    if (funct3 == 0)
-        ret = new SB;
-    else if (funct3 == 0x1)
-        ret = new SH;
-    else if (funct3 == 0x2)
-        ret = new SW;
-    unsigned imm = sgnext((code >> 7 & 0x1F) + ((code >> 25 & 0x7F) << 5), 11);
-    unsigned src1 = code >> 15 & 0x1F;
-    unsigned src2 = code >> 20 & 0x1F;
-    ret->set(imm, src1, src2);
-    return (Inst *) ret;
-}
+class Illegal: public Inst {
+public:
+    static const Op op = OP_ILLEGAL;
+    void set(const Fields &) {}
+    void write_back() {
+        cerr << "illegal instruction " << hex << mem.read_dword(IDEX_inst_addr) << " at "
+             << IDEX_inst_addr << dec << endl;
+        exit(1);
+    }
+};
 
-Inst * BTypeInst::parse(unsigned code) {
-    BTypeInst * ret;
-    unsigned funct3 = code >> 12 & 0x7;
-    if (funct3 == 0)
-        ret = new BEQ;
-    else if (funct3 == 0x1)
-        ret = new BNE;
-    else if (funct3 == 0x4)
-        ret = new BLT;
-    else if (funct3 == 0x5)
-        ret = new BGE;
-    else if (funct3 == 0x6)
-        ret = new BLTU;
-    else if (funct3 == 0x7)
-        ret = new BGEU;
-    unsigned imm = sgnext(((code >> 8 & 0xF) << 1) + ((code >> 25 & 0x3F) << 5) +
-        ((code >> 7 & 0x1) << 11) + ((code >> 31 & 1) << 12), 12);
-    unsigned src1 = code >> 15 & 0x1F;
-    unsigned src2 = code >> 20 & 0x1F;
-    ret->set(imm, src1, src2);
-    return (Inst *) ret;
-}
+constexpr HandlerTable<Inst, Illegal, LUI, AUIPC, JAL, JALR, BEQ, BNE, BLT, BGE, BLTU, BGEU, LB, LH,
+                       LW, LBU, LHU, SB, SH, SW, ADDI, SLTI, SLTIU, XORI, ORI, ANDI, SLLI, SRLI,
+                       SRAI, ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND> handler;
 
-Inst * UTypeInst::parse(unsigned code) {
-    UTypeInst * ret;
-    unsigned opcode = code & 0x7F;
-    if (opcode == 0x37)
-        ret = new LUI;
-    else if (opcode == 0x17)
-        ret = new AUIPC;
-    unsigned imm = code & 0xFFFFF000;
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(imm, dest);
-    return (Inst *) ret;
-}
+static_assert(handler.complete(), "handler table misses an Op");
 
-Inst * JTypeInst::parse(unsigned code) {
-    JTypeInst * ret = new JAL;
-    unsigned imm = sgnext(((code >> 21 & 0x3FF) << 1) + ((code >> 20 & 0x1) << 11) +
-        ((code >> 12 & 0xFF) << 12) + ((code >> 31 & 0x1) << 20), 20);
-    unsigned dest = code >> 7 & 0x1F;
-    ret->set(imm, dest);
-    return (Inst *) ret;
+Inst * Inst::parse(unsigned code) {
+    return handler(code);
 }
 
-
 class InstFetch {
 public:
     void work() {
@@ -738,7 +626,7 @@ Execute execute;
 MemoryAccess mem_access;
 WriteBack write_back;
 
-int main() {
+int main(int argc, char * argv[]) {
     pc.load(0);
     mem.initialize();
     reg[0].load(0);
@@ -746,8 +634,11 @@ int main() {
     prog_end = false;
     timer = 0;
     inst = NULL;
+    unsigned long long cycles = 0, insts = 0;
 
     while (!prog_end) {
+        ++cycles;
+        insts += timer == 4;
         switch (timer) {
             case 0: inst_fetch.work(); break;
             case 1: inst_decode.work(inst); break;
@@ -759,6 +650,10 @@ int main() {
         timer = (timer + 1) % 5;
     }
 
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        cerr << "cycles: " << cycles << endl;
+        cerr << "instructions: " << insts << endl;
+    }
     cout << ret_val << endl;
     return 0;
 }
\ No newline at end of file